@@ -8,8 +8,12 @@
 #include <fmt/core.h>
 #include <SDL3_image/SDL_image.h>
 
+#include <array>
 #include <cassert>
+#include <chrono>
+#include <random>
 #include <sstream>
+#include <vector>
 
 using namespace sdl::color;
 
@@ -69,15 +73,79 @@ void testImGuiWindow() {
 	w.startLoop();
 }
 
+void testAtlasPacking() {
+	constexpr int AtlasSize = 2048;
+	constexpr int ImageCount = 20000;
+
+	// Glyph and icon like sizes, with a few larger sprites.
+	std::mt19937 random{1};
+	std::uniform_int_distribution<int> smallSide{6, 48};
+	std::uniform_int_distribution<int> largeSide{48, 256};
+	std::vector<std::pair<int, int>> sizes;
+	for (int i = 0; i < ImageCount; ++i) {
+		if (i % 20 == 0) {
+			sizes.emplace_back(largeSide(random), largeSide(random));
+		} else {
+			sizes.emplace_back(smallSide(random), smallSide(random));
+		}
+	}
+
+	constexpr std::array packings{
+		std::pair{sdl::AtlasPacking::BinaryTree, "BinaryTree"},
+		std::pair{sdl::AtlasPacking::Skyline, "Skyline"},
+		std::pair{sdl::AtlasPacking::MaxRects, "MaxRects"}
+	};
+	fmt::println("Images added to a {}x{} atlas in arrival order until the first one does not fit, border 1", AtlasSize, AtlasSize);
+	for (auto [packing, name] : packings) {
+		sdl::ImageAtlas atlas{AtlasSize, AtlasSize, packing};
+		int added = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for (auto [width, height] : sizes) {
+			if (!atlas.add(width, height, 1)) {
+				break;
+			}
+			++added;
+		}
+		const std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+		fmt::println("{:>10}: {:5} added, occupancy {:5.1f}%, {:8.2f} ms, {:6.0f} inserts/ms",
+			name, added, atlas.getOccupancy() * 100.f, time.count(), added / time.count());
+	}
+
+	constexpr size_t BatchCount = 2300;
+	constexpr std::array sorts{
+		std::pair{sdl::AtlasSort::None, "None"},
+		std::pair{sdl::AtlasSort::Height, "Height"},
+		std::pair{sdl::AtlasSort::Area, "Area"},
+		std::pair{sdl::AtlasSort::MaxSide, "MaxSide"}
+	};
+	std::vector<sdl::AtlasSize> batch;
+	for (size_t i = 0; i < BatchCount; ++i) {
+		batch.push_back(sdl::AtlasSize{sizes[i].first, sizes[i].second});
+	}
+	fmt::println("The first {} images added with addBatch, border 1", batch.size());
+	for (auto [packing, name] : packings) {
+		for (auto [sort, sortName] : sorts) {
+			sdl::ImageAtlas atlas{AtlasSize, AtlasSize, packing};
+			const auto start = std::chrono::steady_clock::now();
+			auto result = atlas.addBatch(batch, 1, sort);
+			const std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+			fmt::println("{:>10} {:>7}: {:5} added, occupancy {:5.1f}%, {:8.2f} ms",
+				name, sortName, result.placedCount, result.occupancy * 100.f, time.count());
+		}
+	}
+}
+
 void showHelp(const std::string& programName) {
 	fmt::println("Usage: {}", programName);
 	fmt::println("\t{} -1 ", programName);
 	fmt::println("\t{} -2 ", programName);
+	fmt::println("\t{} -3 ", programName);
 	fmt::println("");
 	fmt::println("Options:");
 	fmt::println("\t-h --help                show this help");
 	fmt::println("\t-1                       testPrintColors");
 	fmt::println("\t-2                       testImGuiWindow");
+	fmt::println("\t-3                       testAtlasPacking");
 }
 
 void runAll() {
@@ -124,6 +192,8 @@ int main(int argc, char** argv) {
 		} else if (code == "-2") {
 			testImGuiWindow();
 			return 0;
+		} else if (code == "-3") {
+			testAtlasPacking();
 		} else {
 			fmt::println("Incorrect argument {}", code);
 		}
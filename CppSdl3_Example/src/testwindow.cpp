@@ -6,28 +6,32 @@
 #include <fmt/core.h>
 #include <SDL3_image/SDL_image.h>
 
+#include <cmath>
+
 namespace {
 
-	void addSquare(std::vector<sdl::Vertex>& vertices, glm::vec3 position, float size, sdl::Color color) {
-		// Bottom-left triangle
-		vertices.push_back({position + glm::vec3{-size, -size, 0.0f}, {}, color});
-		vertices.push_back({position + glm::vec3{size, -size, 0.0f}, {}, color});
-		vertices.push_back({position + glm::vec3{-size, size, 0.0f}, {}, color});
-		// Top-right triangle
-		vertices.push_back({position + glm::vec3{size, -size, 0.0f}, {}, color});
-		vertices.push_back({position + glm::vec3{size, size, 0.0f}, {}, color});
-		vertices.push_back({position + glm::vec3{-size, size, 0.0f}, {}, color});
+	void addSquare(sdl::Batch<sdl::Vertex>& batch, glm::vec3 position, float size, sdl::Color color) {
+		batch.startBatch();
+		batch.insert({
+			{position + glm::vec3{-size, -size, 0.0f}, {}, color},
+			{position + glm::vec3{size, -size, 0.0f}, {}, color},
+			{position + glm::vec3{size, size, 0.0f}, {}, color},
+			{position + glm::vec3{-size, size, 0.0f}, {}, color}
+		});
+		// Bottom-left and top-right triangle
+		batch.insertIndices({0, 1, 3, 1, 2, 3});
 	}
 
-	void addSquareTexture(std::vector<sdl::Vertex>& vertices, glm::vec3 position, float size, sdl::Color color) {
-		// Bottom-left triangle
-		vertices.push_back({position + glm::vec3{-size, -size, 0.0f}, {0.f, 0.f}, color});
-		vertices.push_back({position + glm::vec3{size, -size, 0.0f}, {1.f, 0.f}, color});
-		vertices.push_back({position + glm::vec3{-size, size, 0.0f}, {0.f, 1.f}, color});
-		// Top-right triangle
-		vertices.push_back({position + glm::vec3{size, -size, 0.0f}, {1.f, 0.f}, color});
-		vertices.push_back({position + glm::vec3{size, size, 0.0f}, {1.f, 1.f}, color});
-		vertices.push_back({position + glm::vec3{-size, size, 0.0f}, {0.f, 1.f}, color});
+	void addSquareTexture(sdl::Batch<sdl::Vertex>& batch, glm::vec3 position, float size, sdl::Color color) {
+		batch.startBatch();
+		batch.insert({
+			{position + glm::vec3{-size, -size, 0.0f}, {0.f, 0.f}, color},
+			{position + glm::vec3{size, -size, 0.0f}, {1.f, 0.f}, color},
+			{position + glm::vec3{size, size, 0.0f}, {1.f, 1.f}, color},
+			{position + glm::vec3{-size, size, 0.0f}, {0.f, 1.f}, color}
+		});
+		// Bottom-left and top-right triangle
+		batch.insertIndices({0, 1, 3, 1, 2, 3});
 	}
 
 	void printGameControllerButton(Uint8 button) {
@@ -105,6 +109,8 @@ TestWindow::TestWindow() {
 	sdl::Window::setIcon("tetris.bmp");
 	sdl::Window::setShowDemoWindow(true);
 	sdl::Window::setShowColorWindow(true);
+	sdl::Window::setShowGpuMemoryWindow(true);
+	sdl::Window::setShowProfilerWindow(true);
 }
 
 void TestWindow::processEvent(const SDL_Event& windowEvent) {
@@ -225,63 +231,31 @@ void TestWindow::renderFrame(const sdl::DeltaTime& deltaTime, SDL_GPUTexture* sw
 		.store_op = SDL_GPU_STOREOP_STORE,
 	};
 
-	SDL_GPURenderPass* renderPass = SDL_BeginGPURenderPass(commandBuffer, &targetInfo, 1, nullptr);
+	// The orbiting square changes every frame, it is rebuilt and streamed to the GPU before the render pass.
+	time_ += deltaTime;
+	float seconds = std::chrono::duration<float>(time_).count();
+	frameBatch_.clear();
+	frameBatch_.setDrawState(sdl::DrawState{
+		.pipeline = myGraphicsPipeline_,
+		.texture = texture_.get(),
+		.sampler = sampler_
+	});
+	addSquare(frameBatch_, glm::vec3{0.6f * std::cos(seconds), 0.6f * std::sin(seconds), 0.0f}, 0.1f, sdl::color::html::Orange);
 
-	SDL_GPUBufferBinding binding = {
-		.buffer = myVertexBuffer_.get(),
-		.offset = 0
-	};
+	streamingBuffer_.beginFrame(gpuDevice_);
+	auto allocation = streamingBuffer_.push(frameBatch_);
+	streamingBuffer_.endFrame();
+
+	SDL_GPURenderPass* renderPass = SDL_BeginGPURenderPass(commandBuffer, &targetInfo, 1, nullptr);
 
 	[[maybe_unused]] ImVec4 testingVec4{0.0f, 1.0f, 2.0f, 3.0f};
 
 	glm::mat4 projection{1};
 	shader_.uploadProjectionMatrix(commandBuffer, projection);
-		
-	SDL_BindGPUVertexBuffers(
-		renderPass, 
-		0,
-		&binding,
-		1
-	);
-	SDL_BindGPUGraphicsPipeline(renderPass, myGraphicsPipeline_.get());
-	
-	// Draw the first trianges with the first texture
-	SDL_GPUTextureSamplerBinding samplerBinding{
-		.texture = texture_.get(),
-		.sampler = sampler_.get()
-	};
-	SDL_BindGPUFragmentSamplers(
-		renderPass,
-		0,
-		&samplerBinding,
-		1
-	);
-	SDL_DrawGPUPrimitives(
-		renderPass,
-		(Uint32) vertexes_.size() - 6,
-		1,
-		0,
-		0
-	);
-
-	// Draw the last triangles with the second texture
-	samplerBinding = SDL_GPUTextureSamplerBinding{
-		.texture = atlas_.get(),
-		.sampler = sampler_.get()
-	};
-	SDL_BindGPUFragmentSamplers(
-		renderPass,
-		0,
-		&samplerBinding,
-		1
-	);
-	SDL_DrawGPUPrimitives(
-		renderPass,
-		6,
-		1,
-		(Uint32) vertexes_.size() - 6,
-		0 
-	);
+
+	// Pipeline and texture binds are recorded in the mesh draw commands
+	mesh_.draw(renderPass);
+	frameBatch_.draw(renderPass, streamingBuffer_.getBinding(allocation.vertices), streamingBuffer_.getBinding(allocation.indices));
 
 	SDL_EndGPURenderPass(renderPass);
 }
@@ -289,94 +263,31 @@ void TestWindow::renderFrame(const sdl::DeltaTime& deltaTime, SDL_GPUTexture* sw
 void TestWindow::addSurfaceToAtlas(SDL_Surface* surface, int border) {
 	fmt::println("Adding surface to atlas: {}x{}, format: {}", 
 		surface->w, surface->h, SDL_GetPixelFormatName(surface->format));
-	auto _ = sdl::blitToGpuTexture(gpuDevice_, atlas_.get(), imageAtlas_, surface, border);
+	// Uploaded with the other blits of the frame, when the frame is rendered.
+	auto _ = getAtlasStaging().blit(surface, atlas_.get(), imageAtlas_, border);
 }
 
 void TestWindow::preLoop() {
-	sampler_ = sdl::createGpuSampler(gpuDevice_, SDL_GPUSamplerCreateInfo{
-		.min_filter = SDL_GPU_FILTER_NEAREST,
-		.mag_filter = SDL_GPU_FILTER_NEAREST,
-		.mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_NEAREST,
-		.address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
-		.address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
-		.address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE
-	});
+	sampler_ = getSamplerCache().get(sdl::SamplerPreset::NearestClamp);
 
 	[[maybe_unused]] sdl::Color color{0.2f, 0.2f, 0.2f, 1.0f};
 
+	// Both textures are uploaded in one copy pass and one submission.
+	sdl::UploadQueue uploadQueue{gpuDevice_};
 	auto surface = sdl::makeSdlUnique<SDL_Surface, SDL_DestroySurface>(IMG_Load("tetris.bmp"));
-	texture_ = sdl::uploadSurface(gpuDevice_, surface.get());
+	texture_ = uploadQueue.uploadSurface(surface.get());
 
 	auto transparentSurface = createSdlSurface(600, 600, sdl::color::Transparent);
-	atlas_ = sdl::uploadSurface(gpuDevice_, transparentSurface.get());
+	atlas_ = uploadQueue.uploadSurface(transparentSurface.get());
+	uploadQueue.submit();
 
 	sdl::GameController::loadGameControllerMappings("gamecontrollerdb.txt");
 	//setHitTestCallback([](const SDL_Point&) { return SDL_HITTEST_DRAGGABLE; });
 
-	// --- Setup Rectangle Vertex Data ---
-	addSquare(vertexes_, glm::vec3{-0.5f, -0.5f, 0.0f}, 0.2f, sdl::color::Red);
-	addSquareTexture(vertexes_, glm::vec3{0.7f, 0.7f, 0.0f}, 0.2f, sdl::color::White);
-
-	// Triangle 1 (bottom-left)
-	vertexes_.push_back({{-0.5f, -0.5f, 0.0f}, {}, sdl::color::Red});
-	vertexes_.push_back({{0.5f, -0.5f, 0.0f}, {}, sdl::color::Green});
-	vertexes_.push_back({{-0.5f, 0.5f, 0.0f}, {}, sdl::color::Blue});
-
-	// Triangle 2 (top-right);
-	vertexes_.push_back({{0.5f, -0.5f, 0.0f}, {}, sdl::color::Green});
-	vertexes_.push_back({{0.5f, 0.5f, 0.0f}, {}, sdl::color::html::Yellow});
-	vertexes_.push_back({{-0.5f, 0.5f, 0.0f}, {}, sdl::color::Blue});
-
-	// To be used with the atlas texture
-	addSquareTexture(vertexes_, glm::vec3{0.0f, 0.0f, 0.0f}, 1.0f, sdl::color::White);
-
-	auto device = gpuDevice_;
-
-	SDL_GPUBufferCreateInfo bufferInfo{
-		.usage = SDL_GPU_BUFFERUSAGE_VERTEX,
-		.size = (Uint32) vertexes_.size() * sizeof(sdl::Vertex)
-	};
-
-	myVertexBuffer_ = sdl::createGpuBuffer(gpuDevice_, bufferInfo);
-
-	// create the vertex buffer
-	SDL_GPUTransferBufferCreateInfo transferInfo{
-		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-		.size = (Uint32) vertexes_.size() * sizeof(sdl::Vertex)
-	};
-	sdl::GpuTransferBuffer transferBuffer = sdl::createGpuTransferBuffer(gpuDevice_, transferInfo);
-
-	// map the transfer buffer to a pointer
-	sdl::mapGpuTransferBuffer(gpuDevice_, transferBuffer.get(), vertexes_);
-
-	// start a copy pass
-	SDL_GPUCommandBuffer* commandBuffer = SDL_AcquireGPUCommandBuffer(device);
-	sdl::gpuCopyPass(commandBuffer, [&](SDL_GPUCopyPass* copyPass) {
-		// where is the data
-		SDL_GPUTransferBufferLocation location{
-			.transfer_buffer = transferBuffer.get(),
-			.offset = 0
-		};
-
-		// where to upload the data
-		SDL_GPUBufferRegion region{
-			.buffer = myVertexBuffer_.get(),
-			.size = (Uint32) vertexes_.size() * sizeof(sdl::Vertex)
-		};
-
-		// upload the data
-		SDL_UploadToGPUBuffer(copyPass, &location, &region, true);
-	});
-	SDL_SubmitGPUCommandBuffer(commandBuffer);
-
 	// Create the graphics pipeline -------------------------
 
 	// describe the vertex buffers
-	SDL_GPUVertexBufferDescription vertexBufferDescriptions{
-		.slot = 0,
-		.pitch = sizeof(sdl::Vertex),
-		.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX
-	};
+	auto vertexBufferDescriptions = sdl::vertexBufferDescription<sdl::Vertex>();
 
 	SDL_GPUColorTargetDescription colorTargetDescription{
 		.format = SDL_GetGPUSwapchainTextureFormat(gpuDevice_, getSdlWindow()),
@@ -409,11 +320,40 @@ void TestWindow::preLoop() {
 			.num_color_targets = 1,
 		}
 	};
-	myGraphicsPipeline_ = sdl::createGpuGraphicsPipeline(gpuDevice_, pipelineInfo);
-	if (!myGraphicsPipeline_) {
-		spdlog::error("Failed to create graphics pipeline: {}", SDL_GetError());
-		return;
-	}
+	myGraphicsPipeline_ = getPipelineCache().get(pipelineInfo);
+
+	// --- Setup Rectangle Vertex Data ---
+	sdl::Batch<sdl::Vertex> batch;
+	batch.setDrawState(sdl::DrawState{
+		.pipeline = myGraphicsPipeline_,
+		.texture = texture_.get(),
+		.sampler = sampler_
+	});
+	addSquare(batch, glm::vec3{-0.5f, -0.5f, 0.0f}, 0.2f, sdl::color::Red);
+	addSquareTexture(batch, glm::vec3{0.7f, 0.7f, 0.0f}, 0.2f, sdl::color::White);
+
+	batch.startBatch();
+	batch.insert({
+		{{-0.5f, -0.5f, 0.0f}, {}, sdl::color::Red},
+		{{0.5f, -0.5f, 0.0f}, {}, sdl::color::Green},
+		{{0.5f, 0.5f, 0.0f}, {}, sdl::color::html::Yellow},
+		{{-0.5f, 0.5f, 0.0f}, {}, sdl::color::Blue}
+	});
+	// Triangle 1 (bottom-left) and triangle 2 (top-right)
+	batch.insertIndices({0, 1, 3, 1, 2, 3});
+
+	// To be used with the atlas texture
+	batch.setDrawState(sdl::DrawState{
+		.pipeline = myGraphicsPipeline_,
+		.texture = atlas_.get(),
+		.sampler = sampler_
+	});
+	addSquareTexture(batch, glm::vec3{0.0f, 0.0f, 0.0f}, 1.0f, sdl::color::White);
+
+	// The geometry never changes, upload it once and let the batch go
+	SDL_GPUCommandBuffer* commandBuffer = SDL_AcquireGPUCommandBuffer(gpuDevice_);
+	mesh_ = batch.bake(gpuDevice_, commandBuffer);
+	SDL_SubmitGPUCommandBuffer(commandBuffer);
 }
 
 void TestWindow::renderImGui(const sdl::DeltaTime& deltaTime) {
@@ -2,9 +2,11 @@
 #define TESTIMGUIWINDOW_H
 
 #include <sdl/shader.h>
+#include <sdl/staticmesh.h>
 #include <sdl/window.h>
 #include <sdl/gamecontroller.h>
 #include <sdl/gpu.h>
+#include <sdl/gpuutil.h>
 #include <sdl/imageatlas.h>
 
 #include <functional>
@@ -43,11 +45,13 @@ private:
 	int controllerEvent_ = 0;
 	std::vector<sdl::GameController> gameControllers_;
 
-	sdl::GpuBuffer myVertexBuffer_;
-	sdl::GpuGraphicsPipeline myGraphicsPipeline_;
-	sdl::GpuSampler sampler_;
+	SDL_GPUGraphicsPipeline* myGraphicsPipeline_ = nullptr;
+	SDL_GPUSampler* sampler_ = nullptr;
 	sdl::GpuTexture texture_;
-	std::vector<sdl::Vertex> vertexes_;
+	sdl::StaticMesh mesh_;
+	sdl::Batch<sdl::Vertex> frameBatch_;
+	sdl::StreamingBuffer streamingBuffer_;
+	sdl::DeltaTime time_{};
 	sdl::GpuTexture atlas_;
 
 	sdl::Shader shader_;
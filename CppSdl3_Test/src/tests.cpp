@@ -1,5 +1,34 @@
+#include <sdl/asynctextureloader.h>
+#include <sdl/atlasstaging.h>
+#include <sdl/batch.h>
+#include <sdl/framearena.h>
+#include <sdl/frameprofiler.h>
+#include <sdl/gpubufferpool.h>
+#include <sdl/gpumemory.h>
+#include <sdl/gpureleasequeue.h>
+#include <sdl/imageatlas.h>
+#include <sdl/meshoptimize.h>
+#include <sdl/mipmap.h>
+#include <sdl/parallelbatch.h>
+#include <sdl/pipelinecache.h>
+#include <sdl/shader.h>
+#include <sdl/spriterenderer.h>
+#include <sdl/texturecache.h>
+
 #include <gtest/gtest.h>
 
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_iostream.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <vector>
+
 class Test : public ::testing::Test {
 protected:
 
@@ -12,6 +41,52 @@ protected:
 	void TearDown() override {}
 };
 
+namespace {
+
+	SDL_GPUTexture* fakeTexture(std::uintptr_t id) {
+		return reinterpret_cast<SDL_GPUTexture*>(id);
+	}
+
+	// Adds a quad and switches texture every tenth quad.
+	template <sdl::IndexType Index>
+	void addQuad(sdl::Batch<sdl::Vertex, Index>& batch, size_t nbr) {
+		batch.setDrawState(sdl::DrawState{.texture = fakeTexture(1 + nbr / 10 % 2)});
+		batch.startBatch();
+		float x = static_cast<float>(nbr);
+		batch.insert({
+			{{x, 0.f, 0.f}, {0.f, 0.f}, {1.f, 1.f, 1.f, 1.f}},
+			{{x + 1.f, 0.f, 0.f}, {1.f, 0.f}, {1.f, 1.f, 1.f, 1.f}},
+			{{x + 1.f, 1.f, 0.f}, {1.f, 1.f}, {1.f, 1.f, 1.f, 1.f}},
+			{{x, 1.f, 0.f}, {0.f, 1.f}, {1.f, 1.f, 1.f, 1.f}}
+		});
+		batch.insertIndices({0, 1, 3, 1, 2, 3});
+	}
+
+	class CountingResource : public std::pmr::memory_resource {
+	public:
+		int allocations = 0;
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override {
+			++allocations;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+
+		void do_deallocate(void* pointer, size_t bytes, size_t alignment) override {
+			std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+			return this == &other;
+		}
+	};
+
+	bool equal(const sdl::Vertex& left, const sdl::Vertex& right) {
+		return left.position == right.position && left.tex == right.tex && left.color == right.color;
+	}
+
+}
+
 TEST_F(Test, someTest) {
 	// Given.
 	
@@ -20,3 +95,724 @@ TEST_F(Test, someTest) {
 	EXPECT_TRUE(true);
 	EXPECT_EQ(0, 0);
 }
+
+TEST_F(Test, parallelBatchMatchesSingleThreadedOrder) {
+	// Given.
+	constexpr size_t QuadCount = 1001;
+	sdl::Batch<sdl::Vertex> expected;
+	for (size_t i = 0; i < QuadCount; ++i) {
+		addQuad(expected, i);
+	}
+
+	// When.
+	sdl::ParallelBatch<sdl::Vertex> parallelBatch{4};
+	parallelBatch.record(QuadCount, [](sdl::Batch<sdl::Vertex>& shard, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			addQuad(shard, i);
+		}
+	});
+	sdl::Batch<sdl::Vertex> batch;
+	parallelBatch.mergeInto(batch);
+
+	// Then.
+	ASSERT_EQ(expected.vertices().size(), batch.vertices().size());
+	EXPECT_TRUE(std::ranges::equal(expected.vertices(), batch.vertices(), equal));
+	EXPECT_TRUE(std::ranges::equal(expected.indices(), batch.indices()));
+
+	ASSERT_EQ(expected.commands().size(), batch.commands().size());
+	for (size_t i = 0; i < batch.commands().size(); ++i) {
+		EXPECT_EQ(expected.commands()[i].firstIndex, batch.commands()[i].firstIndex);
+		EXPECT_EQ(expected.commands()[i].indexCount, batch.commands()[i].indexCount);
+		EXPECT_TRUE(expected.commands()[i].state == batch.commands()[i].state);
+	}
+}
+
+TEST_F(Test, batch16BitIndicesSplitIntoDrawRanges) {
+	// Given.
+	constexpr size_t QuadCount = 20'000; // 80'000 vertices, more than 16-bit indices can address
+	sdl::Batch<sdl::Vertex, uint32_t> batch32;
+	sdl::Batch<sdl::Vertex, uint16_t> batch16;
+
+	// When.
+	for (size_t i = 0; i < QuadCount; ++i) {
+		addQuad(batch32, i);
+		addQuad(batch16, i);
+	}
+
+	// Then.
+	ASSERT_EQ(batch32.indices().size(), batch16.indices().size());
+	EXPECT_GT(batch16.commands().size(), batch32.commands().size());
+	for (const auto& command : batch16.commands()) {
+		for (uint32_t i = command.firstIndex; i < command.firstIndex + command.indexCount; ++i) {
+			ASSERT_EQ(batch32.indices()[i], batch16.indices()[i] + static_cast<uint32_t>(command.vertexOffset));
+		}
+	}
+}
+
+TEST_F(Test, drawCommandsRequireRenderAreaAfterScissor) {
+	// Given.
+	const std::array commands{
+		sdl::DrawCommand{
+			.state = sdl::DrawState{.scissor = SDL_Rect{0, 0, 10, 10}},
+			.firstIndex = 0,
+			.indexCount = 6
+		},
+		sdl::DrawCommand{
+			.firstIndex = 6,
+			.indexCount = 6
+		}
+	};
+
+	// When.
+	auto drawWithoutRenderArea = [&]() {
+		sdl::drawCommands(nullptr, commands);
+	};
+
+	// Then.
+	// Without the render area the second command would keep the scissor of the first one.
+	EXPECT_THROW(drawWithoutRenderArea(), std::invalid_argument);
+}
+
+TEST_F(Test, spriteRendererExpandsSpritesToQuads) {
+	// Given.
+	sdl::SpriteRenderer renderer;
+	const sdl::Sprite sprite{
+		.position = {10.f, 20.f},
+		.size = {4.f, 2.f},
+		.color = sdl::color::Red
+	};
+
+	// When.
+	renderer.add(sprite);
+	renderer.add(sprite);
+
+	// Then.
+	const auto& batch = renderer.getBatch();
+	ASSERT_EQ(batch.vertices().size(), 8);
+	ASSERT_EQ(batch.indices().size(), 12);
+	ASSERT_EQ(batch.commands().size(), 1);
+	EXPECT_EQ(batch.vertices()[0].position, glm::vec2(8.f, 19.f));
+	EXPECT_EQ(batch.vertices()[2].position, glm::vec2(12.f, 21.f));
+	EXPECT_EQ(batch.vertices()[7].color, sdl::color::Red);
+	EXPECT_EQ(batch.indices()[6], 4);
+	EXPECT_EQ(batch.indices()[11], 4);
+}
+
+TEST_F(Test, batchInsertTransformedMatchesScalarTransform) {
+	// Given.
+	std::vector<sdl::Vertex> mesh;
+	for (int i = 0; i < 5; ++i) {
+		float v = static_cast<float>(i);
+		mesh.push_back({{v, v * 2.f, v * 3.f}, {v, 0.f}, {1.f, 0.5f, 1.f, 1.f}});
+	}
+	glm::mat4 matrix{1.f};
+	matrix[0] = glm::vec4{0.f, 2.f, 0.f, 0.f};
+	matrix[1] = glm::vec4{-2.f, 0.f, 0.f, 0.f};
+	matrix[3] = glm::vec4{10.f, 20.f, 30.f, 1.f};
+	const glm::mat3x2 matrix2D{glm::vec2{0.f, 2.f}, glm::vec2{-2.f, 0.f}, glm::vec2{10.f, 20.f}};
+	sdl::Batch<sdl::Vertex> batch;
+	sdl::Batch<sdl::SpriteVertex> spriteBatch;
+
+	// When.
+	batch.insertTransformed(mesh, matrix, glm::vec4{0.5f, 1.f, 1.f, 1.f});
+	for (const auto& vertex : mesh) {
+		spriteBatch.pushBack({glm::vec2{vertex.position.x, vertex.position.y}, sdl::Half2{}, sdl::color::White});
+	}
+	sdl::Batch<sdl::SpriteVertex> transformed;
+	transformed.insertTransformed(spriteBatch.vertices(), matrix2D);
+
+	// Then.
+	ASSERT_EQ(batch.vertices().size(), mesh.size());
+	ASSERT_EQ(transformed.vertices().size(), mesh.size());
+	for (size_t i = 0; i < mesh.size(); ++i) {
+		const auto& position = mesh[i].position;
+		EXPECT_EQ(batch.vertices()[i].position, glm::vec3(10.f - 2.f * position.y, 20.f + 2.f * position.x, 30.f + position.z));
+		EXPECT_EQ(batch.vertices()[i].tex, mesh[i].tex);
+		EXPECT_EQ(batch.vertices()[i].color, glm::vec4(0.5f, 0.5f, 1.f, 1.f));
+		EXPECT_EQ(transformed.vertices()[i].position, glm::vec2(10.f - 2.f * position.y, 20.f + 2.f * position.x));
+	}
+}
+
+TEST_F(Test, frameArenaBatchHasNoAllocationsInSteadyState) {
+	// Given.
+	CountingResource upstream;
+	sdl::FrameArena arena{1024, &upstream};
+	auto renderFrame = [&arena] {
+		arena.reset();
+		sdl::Batch<sdl::Vertex> batch{&arena};
+		for (size_t i = 0; i < 1000; ++i) {
+			addQuad(batch, i);
+		}
+		batch.sort();
+		return batch.indices().size();
+	};
+	renderFrame();
+	const int warmUpAllocations = upstream.allocations;
+
+	// When.
+	for (int frame = 0; frame < 10; ++frame) {
+		EXPECT_EQ(renderFrame(), 6000);
+	}
+
+	// Then.
+	EXPECT_GT(warmUpAllocations, 1);
+	EXPECT_EQ(upstream.allocations, warmUpAllocations + 1); // The blocks are merged once, at the first reset
+}
+
+TEST_F(Test, batchOptimizeRemovesDuplicatesAndKeepsTriangles) {
+	// Given.
+	constexpr int Size = 20;
+	sdl::Batch<sdl::Vertex, uint16_t> batch;
+	for (int y = 0; y < Size; ++y) {
+		for (int x = 0; x < Size; ++x) {
+			batch.startBatch();
+			auto fx = static_cast<float>(x);
+			auto fy = static_cast<float>(y);
+			batch.insert({
+				{{fx, fy, 0.f}, {-1.f, -1.f}, {1.f, 1.f, 1.f, 1.f}},
+				{{fx + 1.f, fy, 0.f}, {-1.f, -1.f}, {1.f, 1.f, 1.f, 1.f}},
+				{{fx + 1.f, fy + 1.f, 0.f}, {-1.f, -1.f}, {1.f, 1.f, 1.f, 1.f}},
+				{{fx, fy + 1.f, 0.f}, {-1.f, -1.f}, {1.f, 1.f, 1.f, 1.f}}
+			});
+			batch.insertIndices({0, 1, 3, 1, 2, 3});
+		}
+	}
+	auto triangles = [](const sdl::Batch<sdl::Vertex, uint16_t>& batch) {
+		std::vector<std::array<float, 6>> triangles;
+		for (const auto& command : batch.commands()) {
+			for (uint32_t i = command.firstIndex; i < command.firstIndex + command.indexCount; i += 3) {
+				std::array<float, 6> triangle{};
+				for (uint32_t j = 0; j < 3; ++j) {
+					const auto& position = batch.vertices()[batch.indices()[i + j] + command.vertexOffset].position;
+					triangle[j * 2] = position.x;
+					triangle[j * 2 + 1] = position.y;
+				}
+				triangles.push_back(triangle);
+			}
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	};
+	auto missRatio = [](const sdl::Batch<sdl::Vertex, uint16_t>& batch) {
+		std::vector<uint32_t> indices(batch.indices().begin(), batch.indices().end());
+		return sdl::averageCacheMissRatio(indices, batch.vertices().size());
+	};
+	const auto expectedTriangles = triangles(batch);
+	const float missRatioBefore = missRatio(batch);
+
+	// When.
+	batch.optimize();
+
+	// Then.
+	EXPECT_EQ(batch.vertices().size(), (Size + 1) * (Size + 1));
+	EXPECT_EQ(triangles(batch), expectedTriangles);
+	EXPECT_LT(missRatio(batch), missRatioBefore);
+}
+
+TEST_F(Test, gpuReleaseQueueDefersReleaseWhileRegistered) {
+	// Given.
+	static int released = 0;
+	released = 0;
+	auto release = [](SDL_GPUDevice*, void*) { ++released; };
+	int resource = 0;
+
+	// When.
+	{
+		sdl::GpuReleaseQueue queue{nullptr};
+		sdl::GpuReleaseQueue::release(nullptr, &resource, release);
+		sdl::GpuReleaseQueue::release(nullptr, &resource, release);
+		queue.endFrame(nullptr); // A failed submit keeps the resources pending
+		queue.collect();
+
+		// Then.
+		EXPECT_EQ(released, 0);
+		EXPECT_EQ(queue.getPendingCount(), 2);
+	}
+	EXPECT_EQ(released, 2);
+
+	sdl::GpuReleaseQueue::release(nullptr, &resource, release);
+	EXPECT_EQ(released, 3);
+}
+
+TEST_F(Test, placeUploadAlignsAndStartsNewChunks) {
+	// Given.
+	constexpr Uint32 ChunkSize = 1024;
+
+	// When.
+	auto first = sdl::placeUpload(0, 0, 100, 16, ChunkSize);
+	auto aligned = sdl::placeUpload(100, ChunkSize, 200, 512, ChunkSize);
+	auto full = sdl::placeUpload(712, ChunkSize, 400, 16, ChunkSize);
+	auto oversized = sdl::placeUpload(0, ChunkSize, 4096, 16, ChunkSize);
+	auto exactFit = sdl::placeUpload(1000, ChunkSize, 24, 4, ChunkSize);
+
+	// Then.
+	EXPECT_EQ(first.offset, 0);
+	EXPECT_EQ(first.newChunkSize, ChunkSize);
+	EXPECT_EQ(aligned.offset, 512);
+	EXPECT_EQ(aligned.newChunkSize, 0);
+	EXPECT_EQ(full.offset, 0);
+	EXPECT_EQ(full.newChunkSize, ChunkSize);
+	EXPECT_EQ(oversized.offset, 0);
+	EXPECT_EQ(oversized.newChunkSize, 4096);
+	EXPECT_EQ(exactFit.offset, 1000);
+	EXPECT_EQ(exactFit.newChunkSize, 0);
+}
+
+TEST_F(Test, computeCapacityFollowsGrowthPolicy) {
+	using enum sdl::GrowthPolicy;
+	EXPECT_EQ(sdl::computeCapacity(0, 100, {.policy = Exact}), 100);
+	EXPECT_EQ(sdl::computeCapacity(0, 100, {.policy = PowerOfTwo}), 128);
+	EXPECT_EQ(sdl::computeCapacity(128, 129, {.policy = PowerOfTwo}), 256);
+	EXPECT_EQ(sdl::computeCapacity(100, 101, {.policy = OneAndHalf}), 150);
+	EXPECT_EQ(sdl::computeCapacity(100, 90, {.policy = OneAndHalf}), 100);
+	EXPECT_EQ(sdl::computeCapacity(0, 10, {.policy = PowerOfTwo, .minSize = 64}), 64);
+	EXPECT_EQ(sdl::computeCapacity(1000, 1025, {.policy = PowerOfTwo, .maxSize = 1500}), 1500);
+	EXPECT_EQ(sdl::computeCapacity(1000, 2000, {.policy = PowerOfTwo, .maxSize = 1500}), 2000);
+}
+
+TEST_F(Test, rangeAllocatorAlignsAndCoalesces) {
+	// Given.
+	sdl::RangeAllocator allocator{1024};
+
+	// When.
+	auto first = allocator.allocate(10);
+	auto second = allocator.allocate(100, 64);
+	auto third = allocator.allocate(1000);
+
+	// Then.
+	ASSERT_TRUE(first && second);
+	EXPECT_EQ(*first, 0);
+	EXPECT_EQ(*second, 64);
+	EXPECT_FALSE(third);
+	EXPECT_EQ(allocator.getUsed(), 110);
+
+	allocator.free(*first, 10);
+	allocator.free(*second, 100);
+	EXPECT_EQ(allocator.getUsed(), 0);
+	EXPECT_EQ(allocator.getFreeRangeCount(), 1);
+	EXPECT_EQ(allocator.allocate(1024), 0);
+}
+
+TEST_F(Test, asyncTextureLoaderReportsDecodeErrorsThroughFuture) {
+	// Given.
+	sdl::AsyncTextureLoader loader{nullptr, 2};
+
+	// When.
+	auto first = loader.load("missing_file_1.png");
+	auto second = loader.load("missing_file_2.png");
+	loader.finish();
+
+	// Then.
+	EXPECT_EQ(loader.getPendingCount(), 0);
+	EXPECT_THROW(first.get(), sdl::SdlException);
+	EXPECT_THROW(second.get(), sdl::SdlException);
+}
+
+TEST_F(Test, downsampleRgba32MatchesScalarBoxFilter) {
+	// Given.
+	constexpr int Width = 11;
+	constexpr int Height = 5;
+	std::vector<std::byte> source(Width * Height * 4);
+	for (size_t i = 0; i < source.size(); ++i) {
+		source[i] = static_cast<std::byte>((i * 37) % 256);
+	}
+	auto at = [&](int x, int y, int channel) {
+		return static_cast<int>(source[(std::min(y, Height - 1) * Width + std::min(x, Width - 1)) * 4 + channel]);
+	};
+
+	// When.
+	constexpr int DestinationWidth = Width / 2;
+	constexpr int DestinationHeight = Height / 2;
+	std::vector<std::byte> destination(DestinationWidth * DestinationHeight * 4);
+	sdl::downsampleRgba32(source.data(), Width, Height, Width * 4, destination.data(), DestinationWidth * 4);
+
+	// Then.
+	EXPECT_EQ(sdl::mipLevelCount(Width, Height), 4);
+	EXPECT_EQ(sdl::mipLevelCount(1, 1), 1);
+	for (int y = 0; y < DestinationHeight; ++y) {
+		for (int x = 0; x < DestinationWidth; ++x) {
+			for (int channel = 0; channel < 4; ++channel) {
+				int sum = at(2 * x, 2 * y, channel) + at(2 * x + 1, 2 * y, channel)
+					+ at(2 * x, 2 * y + 1, channel) + at(2 * x + 1, 2 * y + 1, channel);
+				EXPECT_EQ(static_cast<int>(destination[(y * DestinationWidth + x) * 4 + channel]), (sum + 2) / 4);
+			}
+		}
+	}
+}
+
+TEST_F(Test, cookedTextureInfoRoundTrips) {
+	// Given.
+	auto base = sdl::createSdlSurface(SDL_CreateSurface(4, 2, SDL_PIXELFORMAT_RGBA32));
+	auto mip = sdl::createSdlSurface(SDL_CreateSurface(2, 1, SDL_PIXELFORMAT_RGBA32));
+	std::array<SDL_Surface*, 2> levels{base.get(), mip.get()};
+	const sdl::CookedTextureInfo info{
+		.sourceHash = sdl::fnv1a(std::as_bytes(std::span{"a", 1})),
+		.sourceSize = 123,
+		.sourceModifyTime = 456,
+		.width = 4,
+		.height = 2,
+		.levelCount = 2,
+		.rects = {SDL_Rect{0, 0, 2, 2}, SDL_Rect{2, 0, 2, 2}}
+	};
+	const std::string filename = "cookedTextureInfoRoundTrips.ctex";
+
+	// When.
+	sdl::writeCookedTexture(filename, info, levels);
+	auto read = sdl::readCookedTextureInfo(filename);
+	SDL_RemovePath(filename.c_str());
+
+	// Then.
+	EXPECT_EQ(info.sourceHash, 0xaf63dc4c8601ec8cull);
+	ASSERT_TRUE(read);
+	EXPECT_EQ(read->sourceHash, info.sourceHash);
+	EXPECT_EQ(read->sourceSize, 123);
+	EXPECT_EQ(read->sourceModifyTime, 456);
+	EXPECT_EQ(read->width, 4);
+	EXPECT_EQ(read->height, 2);
+	EXPECT_EQ(read->levelCount, 2);
+	ASSERT_EQ(read->rects.size(), 2);
+	EXPECT_EQ(read->rects[1].x, 2);
+	EXPECT_FALSE(sdl::readCookedTextureInfo(filename));
+}
+
+TEST_F(Test, cookedTextureInfoRejectsCorruptHeader) {
+	// Given.
+	auto base = sdl::createSdlSurface(SDL_CreateSurface(1, 1, SDL_PIXELFORMAT_RGBA32));
+	std::array<SDL_Surface*, 1> levels{base.get()};
+	const sdl::CookedTextureInfo info{
+		.width = 1,
+		.height = 1,
+		.rects = {SDL_Rect{0, 0, 1, 1}}
+	};
+	const std::string filename = "cookedTextureInfoRejectsCorruptHeader.ctex";
+	sdl::writeCookedTexture(filename, info, levels);
+
+	size_t size = 0;
+	std::unique_ptr<void, decltype(&SDL_free)> data{SDL_LoadFile(filename.c_str(), &size), SDL_free};
+	ASSERT_TRUE(data);
+
+	// Overwrites one field of the header, width at byte 36, height at 40, level count at 44 and rect count at 48.
+	auto readCorrupted = [&](size_t offset, Uint32 value) {
+		std::vector<std::byte> corrupted(static_cast<const std::byte*>(data.get()), static_cast<const std::byte*>(data.get()) + size);
+		SDL_memcpy(corrupted.data() + offset, &value, sizeof(value));
+		EXPECT_TRUE(SDL_SaveFile(filename.c_str(), corrupted.data(), corrupted.size()));
+		return sdl::readCookedTextureInfo(filename);
+	};
+
+	// When.
+	auto unchanged = readCorrupted(48, 1);
+	auto zeroWidth = readCorrupted(36, 0);
+	auto zeroHeight = readCorrupted(40, 0);
+	auto tooManyLevels = readCorrupted(44, 2);
+	auto tooManyRects = readCorrupted(48, 0xFFFFFFFF);
+	SDL_RemovePath(filename.c_str());
+
+	// Then.
+	EXPECT_TRUE(unchanged);
+	EXPECT_FALSE(zeroWidth);
+	EXPECT_FALSE(zeroHeight);
+	EXPECT_FALSE(tooManyLevels);
+	EXPECT_FALSE(tooManyRects);
+}
+
+TEST_F(Test, pipelineCacheKeyComparesContentNotArrayAddresses) {
+	// Given.
+	auto makeCreateInfo = [](const SDL_GPUVertexBufferDescription& description, const SDL_GPUColorTargetDescription& colorTarget) {
+		return SDL_GPUGraphicsPipelineCreateInfo{
+			.vertex_input_state = SDL_GPUVertexInputState{
+				.vertex_buffer_descriptions = &description,
+				.num_vertex_buffers = 1,
+				.vertex_attributes = sdl::Shader::attributes.data(),
+				.num_vertex_attributes = static_cast<Uint32>(sdl::Shader::attributes.size())
+			},
+			.primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
+			.target_info = SDL_GPUGraphicsPipelineTargetInfo{
+				.color_target_descriptions = &colorTarget,
+				.num_color_targets = 1
+			}
+		};
+	};
+	const auto description1 = sdl::vertexBufferDescription<sdl::Vertex>();
+	const auto description2 = sdl::vertexBufferDescription<sdl::Vertex>();
+	const SDL_GPUColorTargetDescription colorTarget1{.format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM};
+	const SDL_GPUColorTargetDescription colorTarget2{.format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM};
+	auto blended = colorTarget2;
+	blended.blend_state.enable_blend = true;
+
+	// When.
+	auto key1 = sdl::PipelineCache::key(makeCreateInfo(description1, colorTarget1));
+	auto key2 = sdl::PipelineCache::key(makeCreateInfo(description2, colorTarget2));
+	auto blendedKey = sdl::PipelineCache::key(makeCreateInfo(description2, blended));
+
+	// Then.
+	EXPECT_EQ(key1, key2);
+	EXPECT_NE(key1, blendedKey);
+}
+
+TEST_F(Test, gpuMemoryStatsTrackTrackedResourcesUntilReleased) {
+	// Given.
+	using Deleter = sdl::GpuResourceDeleter<SDL_GPUTexture, SDL_ReleaseGPUTexture>;
+	const auto before = sdl::getGpuMemoryStats()[sdl::GpuResourceType::Texture];
+	int dummy = 0;
+	auto resource = reinterpret_cast<SDL_GPUTexture*>(&dummy);
+
+	// When.
+	{
+		sdl::GpuTexture texture{resource, Deleter::tracked(nullptr, 1024, SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM)};
+		const auto stats = sdl::getGpuMemoryStats();
+
+		// Then.
+		EXPECT_EQ(stats[sdl::GpuResourceType::Texture].liveCount, before.liveCount + 1);
+		EXPECT_EQ(stats[sdl::GpuResourceType::Texture].liveBytes, before.liveBytes + 1024);
+		auto format = std::ranges::find(stats.textureFormats, SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM, &sdl::GpuTextureFormatStats::format);
+		ASSERT_NE(format, stats.textureFormats.end());
+		EXPECT_GE(format->liveBytes, 1024);
+	}
+	const auto after = sdl::getGpuMemoryStats()[sdl::GpuResourceType::Texture];
+	EXPECT_EQ(after.liveCount, before.liveCount);
+	EXPECT_EQ(after.liveBytes, before.liveBytes);
+	EXPECT_GE(after.peakBytes, before.liveBytes + 1024);
+}
+
+TEST_F(Test, gpuMemoryStatsKeepDeferredResourcesLiveUntilReleased) {
+	// Given.
+	const auto before = sdl::getGpuMemoryStats()[sdl::GpuResourceType::Buffer];
+	sdl::gpu_memory::trackCreate(sdl::GpuResourceType::Buffer, 2048, SDL_GPU_TEXTUREFORMAT_INVALID);
+	auto release = [](SDL_GPUDevice*, void*) {};
+	int resource = 0;
+
+	// When.
+	{
+		sdl::GpuReleaseQueue queue{nullptr};
+		sdl::GpuReleaseQueue::release(nullptr, &resource, release, sdl::gpu_memory::TrackedResource{
+			.type = sdl::GpuResourceType::Buffer,
+			.bytes = 2048
+		});
+		const auto pending = sdl::getGpuMemoryStats()[sdl::GpuResourceType::Buffer];
+
+		// Then.
+		EXPECT_EQ(pending.liveCount, before.liveCount + 1);
+		EXPECT_EQ(pending.liveBytes, before.liveBytes + 2048);
+	}
+	const auto after = sdl::getGpuMemoryStats()[sdl::GpuResourceType::Buffer];
+	EXPECT_EQ(after.liveCount, before.liveCount);
+	EXPECT_EQ(after.liveBytes, before.liveBytes);
+}
+
+TEST_F(Test, profilerHistoryPercentilesUseLatestSamples) {
+	// Given.
+	sdl::ProfilerHistory history{100};
+	for (int i = 1000; i > 0; --i) {
+		history.push(1000.f);
+	}
+
+	// When.
+	for (int i = 100; i > 0; --i) {
+		history.push(static_cast<float>(i));
+	}
+
+	// Then.
+	EXPECT_EQ(history.values().size(), 100);
+	EXPECT_FLOAT_EQ(history.latest(), 1.f);
+	EXPECT_FLOAT_EQ(history.percentile(0.50f), 50.f);
+	EXPECT_FLOAT_EQ(history.percentile(0.95f), 95.f);
+	EXPECT_FLOAT_EQ(history.percentile(0.99f), 99.f);
+	EXPECT_FLOAT_EQ(history.percentile(1.f), 100.f);
+	EXPECT_FLOAT_EQ(history.values()[history.getOffset()], 100.f);
+}
+
+TEST_F(Test, imageAtlasStrategiesPackWithoutOverlap) {
+	for (auto packing : {sdl::AtlasPacking::BinaryTree, sdl::AtlasPacking::Skyline, sdl::AtlasPacking::MaxRects}) {
+		// Given.
+		sdl::ImageAtlas atlas{256, 256, packing};
+		sdl::ImageAtlas tiles{256, 256, packing};
+		std::vector<SDL_Rect> rects;
+
+		// When.
+		for (int i = 0; i < 200; ++i) {
+			if (auto rect = atlas.add(3 + (i * 7) % 29, 3 + (i * 13) % 23, 1)) {
+				rects.push_back(*rect);
+			}
+		}
+		for (int i = 0; i < 64; ++i) {
+			ASSERT_TRUE(tiles.add(32, 32));
+		}
+
+		// Then.
+		EXPECT_FALSE(rects.empty());
+		for (size_t i = 0; i < rects.size(); ++i) {
+			const auto& a = rects[i];
+			EXPECT_TRUE(a.x >= 1 && a.y >= 1 && a.x + a.w + 1 <= 256 && a.y + a.h + 1 <= 256);
+			for (size_t j = i + 1; j < rects.size(); ++j) {
+				const auto& b = rects[j];
+				EXPECT_FALSE(a.x - 1 < b.x + b.w + 1 && b.x - 1 < a.x + a.w + 1 && a.y - 1 < b.y + b.h + 1 && b.y - 1 < a.y + a.h + 1);
+			}
+		}
+		EXPECT_FLOAT_EQ(tiles.getOccupancy(), 1.f);
+		EXPECT_FALSE(tiles.add(1, 1));
+	}
+}
+
+TEST_F(Test, imageAtlasRemoveCoalescesAndDefragmentCompacts) {
+	for (auto packing : {sdl::AtlasPacking::BinaryTree, sdl::AtlasPacking::Skyline, sdl::AtlasPacking::MaxRects}) {
+		// Given.
+		sdl::ImageAtlas atlas{256, 256, packing};
+		std::vector<sdl::AtlasHandle> handles;
+		for (int i = 0; i < 64; ++i) {
+			auto handle = atlas.insert(30, 30, 1);
+			ASSERT_TRUE(handle);
+			handles.push_back(*handle);
+		}
+
+		// When.
+		std::vector<sdl::AtlasHandle> bottomHalf;
+		for (auto handle : handles) {
+			if (atlas.getRect(handle)->y < 128) {
+				EXPECT_TRUE(atlas.remove(handle));
+			} else {
+				bottomHalf.push_back(handle);
+			}
+		}
+		auto moves = atlas.defragment(100);
+
+		// Then.
+		EXPECT_FALSE(atlas.remove(handles.front()));
+		ASSERT_EQ(moves.size(), 32);
+		for (const auto& move : moves) {
+			EXPECT_EQ(atlas.getRect(move.handle)->x, move.to.x);
+			EXPECT_EQ(atlas.getRect(move.handle)->y, move.to.y);
+			EXPECT_LT(move.to.y + move.to.h, move.from.y);
+		}
+		for (auto handle : bottomHalf) {
+			EXPECT_LT(atlas.getRect(handle)->y, 128);
+			EXPECT_TRUE(atlas.remove(handle));
+		}
+		EXPECT_EQ(atlas.getSize(), 0);
+		EXPECT_EQ(atlas.getUsedArea(), 0);
+		EXPECT_TRUE(atlas.add(256, 256));
+	}
+}
+
+TEST_F(Test, imageAtlasRemoveOfMixedSizesFreesAllSpace) {
+	for (auto packing : {sdl::AtlasPacking::BinaryTree, sdl::AtlasPacking::Skyline, sdl::AtlasPacking::MaxRects}) {
+		// Given.
+		sdl::ImageAtlas atlas{256, 256, packing};
+		std::vector<sdl::AtlasHandle> handles;
+		for (auto [width, height] : {std::pair{100, 50}, {50, 100}, {150, 20}, {10, 10}, {37, 61}, {90, 13}}) {
+			auto handle = atlas.insert(width, height, 1);
+			ASSERT_TRUE(handle);
+			handles.push_back(*handle);
+		}
+
+		// When.
+		for (auto handle : handles) {
+			EXPECT_TRUE(atlas.remove(handle));
+		}
+
+		// Then.
+		EXPECT_EQ(atlas.getUsedArea(), 0);
+		EXPECT_TRUE(atlas.insert(256, 256));
+	}
+}
+
+TEST_F(Test, imageAtlasRemoveAndInsertStayCheapWithThousandsOfImages) {
+	for (auto packing : {sdl::AtlasPacking::BinaryTree, sdl::AtlasPacking::Skyline, sdl::AtlasPacking::MaxRects}) {
+		// Given.
+		sdl::ImageAtlas atlas{2048, 2048, packing};
+		std::vector<sdl::AtlasHandle> handles;
+		for (int i = 0; handles.size() < 3800; ++i) {
+			auto handle = atlas.insert(8 + i % 23, 10 + i % 19, 1);
+			ASSERT_TRUE(handle);
+			handles.push_back(*handle);
+		}
+		constexpr int Cycles = 100;
+
+		// When.
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < Cycles; ++i) {
+			auto& handle = handles[(i * 7919) % handles.size()];
+			ASSERT_TRUE(atlas.remove(handle));
+			auto inserted = atlas.insert(8 + i % 23, 10 + i % 19, 1);
+			ASSERT_TRUE(inserted);
+			handle = *inserted;
+			if (i % 25 == 0) {
+				atlas.defragment(4);
+			}
+		}
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+
+		// Then.
+		// Well under a millisecond in a release build, a rebuild of the free space per remove takes hundreds.
+		// The cap leaves room for debug builds.
+		EXPECT_LT(elapsed / Cycles, std::chrono::milliseconds{50});
+		EXPECT_EQ(atlas.getSize(), handles.size());
+	}
+}
+
+TEST_F(Test, imageAtlasGrowKeepsImagesAndAddsSpace) {
+	for (auto packing : {sdl::AtlasPacking::BinaryTree, sdl::AtlasPacking::Skyline, sdl::AtlasPacking::MaxRects}) {
+		// Given.
+		sdl::ImageAtlas atlas{64, 64, packing};
+		std::vector<std::pair<sdl::AtlasHandle, SDL_Rect>> images;
+		for (int i = 0; i < 4; ++i) {
+			auto handle = atlas.insert(32, 32);
+			ASSERT_TRUE(handle);
+			images.emplace_back(*handle, *atlas.getRect(*handle));
+		}
+		ASSERT_FALSE(atlas.add(32, 32));
+
+		// When.
+		atlas.grow(128, 128);
+
+		// Then.
+		for (const auto& [handle, rect] : images) {
+			EXPECT_EQ(atlas.getRect(handle)->x, rect.x);
+			EXPECT_EQ(atlas.getRect(handle)->y, rect.y);
+		}
+		for (int i = 0; i < 12; ++i) {
+			auto rect = atlas.add(32, 32);
+			ASSERT_TRUE(rect);
+			EXPECT_TRUE(rect->x >= 64 || rect->y >= 64);
+		}
+		EXPECT_FALSE(atlas.add(1, 1));
+		EXPECT_THROW(atlas.grow(64, 128), std::invalid_argument);
+	}
+}
+
+TEST_F(Test, imageAtlasAddBatchPacksLargestFirstAndKeepsInputOrder) {
+	// Given.
+	const std::array<sdl::AtlasSize, 2> sizes{{{10, 10}, {64, 54}}};
+	sdl::ImageAtlas arrivalOrder{64, 64};
+	sdl::ImageAtlas batch{64, 64};
+
+	// When.
+	auto result = batch.addBatch(sizes);
+
+	// Then.
+	ASSERT_TRUE(arrivalOrder.add(10, 10));
+	EXPECT_FALSE(arrivalOrder.add(64, 54));
+	EXPECT_EQ(result.placedCount, 2);
+	ASSERT_TRUE(result.rects[0] && result.rects[1]);
+	EXPECT_EQ(result.rects[0]->w, 10);
+	EXPECT_EQ(result.rects[1]->w, 64);
+	EXPECT_FLOAT_EQ(result.occupancy, (10 * 10 + 64 * 54) / (64.f * 64.f));
+	EXPECT_NE(result.sort, sdl::AtlasSort::Best);
+}
+
+TEST_F(Test, atlasStagingCollectsDirtyRegionsUntilFlush) {
+	// Given.
+	sdl::AtlasStaging staging{nullptr};
+	sdl::ImageAtlas atlas{64, 64};
+	auto large = sdl::createSdlSurface(SDL_CreateSurface(10, 10, SDL_PIXELFORMAT_RGBA32));
+	auto small = sdl::createSdlSurface(SDL_CreateSurface(3, 2, SDL_PIXELFORMAT_RGBA32));
+
+	// When.
+	auto largeRect = staging.blit(large.get(), nullptr, atlas, 1);
+	auto smallRect = staging.blit(small.get(), nullptr, atlas);
+
+	// Then.
+	EXPECT_EQ(largeRect.w, 10);
+	EXPECT_EQ(smallRect.h, 2);
+	EXPECT_EQ(staging.getDirtyCount(), 2);
+	EXPECT_EQ(staging.getStagedBytes(), 512 + 3 * 2 * 4);
+}
@@ -0,0 +1,234 @@
+#include "asynctextureloader.h"
+#include "sdlexception.h"
+
+#include <SDL3_image/SDL_image.h>
+
+#include <limits>
+#include <memory>
+
+namespace sdl {
+
+	namespace {
+
+		SdlSurface toRgba32(SdlSurface surface) {
+			if (surface->format == SDL_PIXELFORMAT_RGBA32) {
+				return surface;
+			}
+			auto converted = SDL_ConvertSurface(surface.get(), SDL_PIXELFORMAT_RGBA32);
+			if (!converted) {
+				throw sdl::SdlException{"[AsyncTextureLoader] Failed to convert surface to RGBA32"};
+			}
+			return createSdlSurface(converted);
+		}
+
+		SdlSurface loadImage(const std::string& filename) {
+			auto surface = IMG_Load(filename.c_str());
+			if (!surface) {
+				throw sdl::SdlException{"[AsyncTextureLoader] Failed to load surface from file '{}'", filename};
+			}
+			return toRgba32(createSdlSurface(surface));
+		}
+
+	}
+
+	AsyncTextureLoader::AsyncTextureLoader(SDL_GPUDevice* gpuDevice, size_t threadCount, size_t frameBudget)
+		: gpuDevice_{gpuDevice}
+		, frameBudget_{frameBudget} {
+
+		threadCount = std::max<size_t>(threadCount, 1);
+		threads_.reserve(threadCount);
+		for (size_t i = 0; i < threadCount; ++i) {
+			threads_.emplace_back([this](std::stop_token stopToken) {
+				work(stopToken);
+			});
+		}
+	}
+
+	AsyncTextureLoader::~AsyncTextureLoader() {
+		// Joins the workers before the queues they use are destroyed.
+		threads_.clear();
+	}
+
+	std::future<GpuTexture> AsyncTextureLoader::load(const std::string& filename) {
+		auto promise = std::make_shared<std::promise<GpuTexture>>();
+		auto future = promise->get_future();
+		enqueue(Job{
+			.decode = [filename]() {
+				return loadImage(filename);
+			},
+			.upload = [promise](UploadQueue& uploadQueue, SDL_Surface* surface) -> std::move_only_function<void()> {
+				return [promise, texture = uploadQueue.uploadSurface(surface)]() mutable {
+					promise->set_value(std::move(texture));
+				};
+			},
+			.fail = [promise](std::exception_ptr exception) {
+				promise->set_exception(exception);
+			}
+		});
+		return future;
+	}
+
+	std::future<GpuTexture> AsyncTextureLoader::load(SdlSurface surface) {
+		auto promise = std::make_shared<std::promise<GpuTexture>>();
+		auto future = promise->get_future();
+		enqueue(Job{
+			.decode = [surface = std::move(surface)]() mutable {
+				return toRgba32(std::move(surface));
+			},
+			.upload = [promise](UploadQueue& uploadQueue, SDL_Surface* surface) -> std::move_only_function<void()> {
+				return [promise, texture = uploadQueue.uploadSurface(surface)]() mutable {
+					promise->set_value(std::move(texture));
+				};
+			},
+			.fail = [promise](std::exception_ptr exception) {
+				promise->set_exception(exception);
+			}
+		});
+		return future;
+	}
+
+	std::future<SDL_Rect> AsyncTextureLoader::loadToAtlas(const std::string& filename, SDL_GPUTexture* texture, ImageAtlas& imageAtlas, int border) {
+		auto promise = std::make_shared<std::promise<SDL_Rect>>();
+		auto future = promise->get_future();
+		enqueue(Job{
+			.decode = [filename]() {
+				return loadImage(filename);
+			},
+			.upload = [promise, texture, &imageAtlas, border](UploadQueue& uploadQueue, SDL_Surface* surface) -> std::move_only_function<void()> {
+				return [promise, rect = uploadQueue.blitSurface(surface, texture, imageAtlas, border)]() {
+					promise->set_value(rect);
+				};
+			},
+			.fail = [promise](std::exception_ptr exception) {
+				promise->set_exception(exception);
+			}
+		});
+		return future;
+	}
+
+	void AsyncTextureLoader::update() {
+		complete(false);
+		uploadDecoded(frameBudget_);
+	}
+
+	void AsyncTextureLoader::finish() {
+		while (true) {
+			{
+				std::unique_lock lock{mutex_};
+				decodedCondition_.wait(lock, [this]() {
+					return !decoded_.empty() || (jobs_.empty() && decoding_ == 0);
+				});
+				if (decoded_.empty()) {
+					break;
+				}
+			}
+			uploadDecoded(std::numeric_limits<size_t>::max());
+		}
+		complete(true);
+	}
+
+	size_t AsyncTextureLoader::getPendingCount() const {
+		size_t count = 0;
+		for (const auto& inFlight : inFlight_) {
+			count += inFlight.completions.size();
+		}
+		std::lock_guard lock{mutex_};
+		return count + jobs_.size() + decoding_ + decoded_.size();
+	}
+
+	void AsyncTextureLoader::enqueue(Job job) {
+		{
+			std::lock_guard lock{mutex_};
+			jobs_.push_back(std::move(job));
+		}
+		condition_.notify_one();
+	}
+
+	void AsyncTextureLoader::work(std::stop_token stopToken) {
+		while (true) {
+			Job job;
+			{
+				std::unique_lock lock{mutex_};
+				if (!condition_.wait(lock, stopToken, [this]() { return !jobs_.empty(); })) {
+					return;
+				}
+				job = std::move(jobs_.front());
+				jobs_.pop_front();
+				++decoding_;
+			}
+
+			Decoded decoded{
+				.upload = std::move(job.upload),
+				.fail = std::move(job.fail)
+			};
+			try {
+				decoded.surface = job.decode();
+			} catch (...) {
+				decoded.exception = std::current_exception();
+			}
+
+			{
+				std::lock_guard lock{mutex_};
+				--decoding_;
+				decoded_.push_back(std::move(decoded));
+			}
+			decodedCondition_.notify_all();
+		}
+	}
+
+	void AsyncTextureLoader::uploadDecoded(size_t budget) {
+		std::vector<Decoded> ready;
+		{
+			std::lock_guard lock{mutex_};
+			size_t bytes = 0;
+			while (!decoded_.empty() && (ready.empty() || bytes < budget)) {
+				auto& decoded = decoded_.front();
+				if (decoded.surface) {
+					bytes += static_cast<size_t>(decoded.surface->pitch) * decoded.surface->h;
+				}
+				ready.push_back(std::move(decoded));
+				decoded_.pop_front();
+			}
+		}
+		if (ready.empty()) {
+			return;
+		}
+
+		UploadQueue uploadQueue{gpuDevice_, static_cast<Uint32>(std::min<size_t>(frameBudget_, UploadQueue::DefaultChunkSize))};
+		std::vector<std::move_only_function<void()>> completions;
+		for (auto& decoded : ready) {
+			if (decoded.exception) {
+				decoded.fail(decoded.exception);
+				continue;
+			}
+			try {
+				completions.push_back(decoded.upload(uploadQueue, decoded.surface.get()));
+			} catch (...) {
+				decoded.fail(std::current_exception());
+			}
+		}
+		if (!completions.empty()) {
+			inFlight_.push_back(InFlight{
+				.fence = uploadQueue.submit(),
+				.completions = std::move(completions)
+			});
+		}
+	}
+
+	void AsyncTextureLoader::complete(bool wait) {
+		while (!inFlight_.empty()) {
+			auto& inFlight = inFlight_.front();
+			SDL_GPUFence* fence = inFlight.fence.get();
+			if (wait) {
+				SDL_WaitForGPUFences(gpuDevice_, true, &fence, 1);
+			} else if (!SDL_QueryGPUFence(gpuDevice_, fence)) {
+				break;
+			}
+			for (auto& completion : inFlight.completions) {
+				completion();
+			}
+			inFlight_.pop_front();
+		}
+	}
+
+}
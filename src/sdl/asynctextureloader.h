@@ -0,0 +1,122 @@
+#ifndef CPPSDL3_SDL_ASYNCTEXTURELOADER_H
+#define CPPSDL3_SDL_ASYNCTEXTURELOADER_H
+
+#include "gpu.h"
+#include "gpuutil.h"
+#include "imageatlas.h"
+#include "util.h"
+
+#include <SDL3/SDL_gpu.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sdl {
+
+	/// @brief Loads images on worker threads and uploads them to the GPU from the render thread.
+	/// Decoding (IMG_Load) and the conversion to RGBA32 run on the workers. update(), called once per
+	/// frame on the render thread, uploads the decoded images up to a byte budget in one submission,
+	/// and fulfills the futures once the GPU has finished the upload, i.e. the texture is resident.
+	/// Futures of loads not finished when the loader is destroyed throw std::future_error (broken promise).
+	class AsyncTextureLoader {
+	public:
+		static constexpr size_t DefaultFrameBudget = 4 * 1024 * 1024;
+
+		explicit AsyncTextureLoader(SDL_GPUDevice* gpuDevice,
+			size_t threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1,
+			size_t frameBudget = DefaultFrameBudget);
+
+		~AsyncTextureLoader();
+
+		AsyncTextureLoader(const AsyncTextureLoader&) = delete;
+		AsyncTextureLoader& operator=(const AsyncTextureLoader&) = delete;
+
+		/// @brief Loads the image file into a new sampler texture. Is thread safe.
+		[[nodiscard]]
+		std::future<GpuTexture> load(const std::string& filename);
+
+		/// @brief Converts the surface on a worker and uploads it into a new sampler texture. Is thread safe.
+		[[nodiscard]]
+		std::future<GpuTexture> load(SdlSurface surface);
+
+		/// @brief Loads the image file into the atlas texture. The atlas region is reserved by update()
+		/// on the render thread, so the atlas must not be used by other threads. Is thread safe.
+		[[nodiscard]]
+		std::future<SDL_Rect> loadToAtlas(const std::string& filename, SDL_GPUTexture* texture, ImageAtlas& imageAtlas, int border = 0);
+
+		/// @brief Fulfills the futures of finished uploads and uploads decoded images within the frame budget.
+		/// At least one image is uploaded per call, so images larger than the budget are not stalled.
+		/// Call once per frame from the render thread. Never waits for the GPU.
+		void update();
+
+		/// @brief Blocks until all requested loads are resident.
+		void finish();
+
+		void setFrameBudget(size_t bytes) noexcept {
+			frameBudget_ = bytes;
+		}
+
+		[[nodiscard]]
+		size_t getFrameBudget() const noexcept {
+			return frameBudget_;
+		}
+
+		/// @brief Number of loads not yet resident. Call from the render thread.
+		[[nodiscard]]
+		size_t getPendingCount() const;
+
+	private:
+		// Queues the surface to the upload queue and returns the function which completes the future.
+		using Upload = std::move_only_function<std::move_only_function<void()>(UploadQueue&, SDL_Surface*)>;
+		using Fail = std::move_only_function<void(std::exception_ptr)>;
+
+		struct Job {
+			std::move_only_function<SdlSurface()> decode;
+			Upload upload;
+			Fail fail;
+		};
+
+		struct Decoded {
+			SdlSurface surface;
+			std::exception_ptr exception;
+			Upload upload;
+			Fail fail;
+		};
+
+		struct InFlight {
+			GpuFence fence;
+			std::vector<std::move_only_function<void()>> completions;
+		};
+
+		void enqueue(Job job);
+
+		void work(std::stop_token stopToken);
+
+		void uploadDecoded(size_t budget);
+
+		void complete(bool wait);
+
+		SDL_GPUDevice* gpuDevice_ = nullptr;
+		size_t frameBudget_ = DefaultFrameBudget;
+
+		mutable std::mutex mutex_;
+		std::condition_variable_any condition_;
+		std::condition_variable_any decodedCondition_;
+		std::deque<Job> jobs_;
+		std::deque<Decoded> decoded_;
+		size_t decoding_ = 0;
+
+		std::deque<InFlight> inFlight_;
+		std::vector<std::jthread> threads_;
+	};
+
+}
+
+#endif
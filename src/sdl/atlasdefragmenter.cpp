@@ -0,0 +1,75 @@
+#include "atlasdefragmenter.h"
+
+namespace sdl {
+
+	namespace {
+
+		SDL_Rect paddedRect(SDL_Rect rect, int border) noexcept {
+			rect.x -= border;
+			rect.y -= border;
+			rect.w += 2 * border;
+			rect.h += 2 * border;
+			return rect;
+		}
+
+		SDL_GPUTextureLocation textureLocation(SDL_GPUTexture* texture, const SDL_Rect& rect) noexcept {
+			return SDL_GPUTextureLocation{
+				.texture = texture,
+				.x = static_cast<Uint32>(rect.x),
+				.y = static_cast<Uint32>(rect.y)
+			};
+		}
+
+	}
+
+	AtlasDefragmenter::AtlasDefragmenter(SDL_GPUDevice* gpuDevice, SDL_GPUTextureFormat format, int stagingWidth, int stagingHeight)
+		: staging_{createGpuTexture(gpuDevice, SDL_GPUTextureCreateInfo{
+			.type = SDL_GPU_TEXTURETYPE_2D,
+			.format = format,
+			.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER,
+			.width = static_cast<Uint32>(stagingWidth),
+			.height = static_cast<Uint32>(stagingHeight),
+			.layer_count_or_depth = 1,
+			.num_levels = 1,
+		})}
+		, stagingWidth_{stagingWidth}
+		, stagingHeight_{stagingHeight} {
+	}
+
+	std::vector<AtlasMove> AtlasDefragmenter::update(SDL_GPUCommandBuffer* commandBuffer, SDL_GPUTexture* texture, ImageAtlas& atlas, size_t maxMoves) {
+		// The staging texture is packed from scratch each update, earlier copies are ordered before on the GPU.
+		ImageAtlas stagingAtlas{stagingWidth_, stagingHeight_, AtlasPacking::Skyline};
+		std::vector<SDL_Rect> stagingRects;
+		auto moves = atlas.defragment(maxMoves, [&](int width, int height) {
+			auto rect = stagingAtlas.add(width, height);
+			if (rect) {
+				stagingRects.push_back(*rect);
+			}
+			return rect.has_value();
+		});
+		if (moves.empty()) {
+			return moves;
+		}
+
+		// Two passes, so all reads of the atlas are done before any write to it.
+		auto copyPass = SDL_BeginGPUCopyPass(commandBuffer);
+		for (size_t i = 0; i < moves.size(); ++i) {
+			const auto from = paddedRect(moves[i].from, moves[i].border);
+			const auto source = textureLocation(texture, from);
+			const auto destination = textureLocation(staging_.get(), stagingRects[i]);
+			SDL_CopyGPUTextureToTexture(copyPass, &source, &destination, from.w, from.h, 1, false);
+		}
+		SDL_EndGPUCopyPass(copyPass);
+
+		copyPass = SDL_BeginGPUCopyPass(commandBuffer);
+		for (size_t i = 0; i < moves.size(); ++i) {
+			const auto to = paddedRect(moves[i].to, moves[i].border);
+			const auto source = textureLocation(staging_.get(), stagingRects[i]);
+			const auto destination = textureLocation(texture, to);
+			SDL_CopyGPUTextureToTexture(copyPass, &source, &destination, to.w, to.h, 1, false);
+		}
+		SDL_EndGPUCopyPass(copyPass);
+		return moves;
+	}
+
+}
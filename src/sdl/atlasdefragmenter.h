@@ -0,0 +1,42 @@
+#ifndef CPPSDL3_SDL_ATLASDEFRAGMENTER_H
+#define CPPSDL3_SDL_ATLASDEFRAGMENTER_H
+
+#include "gpu.h"
+#include "imageatlas.h"
+
+#include <SDL3/SDL_gpu.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace sdl {
+
+	/// @brief Compacts an ImageAtlas a few images per frame and moves their pixels on the GPU.
+	/// A texture region can not be copied to another region of the same texture on all backends, so
+	/// the moved images are copied to a staging texture and from it to their new place.
+	/// Only mip level 0 and layer 0 are moved.
+	class AtlasDefragmenter {
+	public:
+		static constexpr size_t DefaultMaxMoves = 16;
+
+		/// @param gpuDevice Device of the atlas texture
+		/// @param format Format of the atlas texture
+		/// @param stagingWidth Width of the staging texture, at least the widest image
+		/// @param stagingHeight Height of the staging texture, limits how much is moved per update
+		AtlasDefragmenter(SDL_GPUDevice* gpuDevice, SDL_GPUTextureFormat format, int stagingWidth, int stagingHeight);
+
+		/// @brief Moves up to maxMoves images of the atlas, see ImageAtlas::defragment, and records the copies.
+		/// The atlas rects change directly. Use the returned moves, e.g. with atlasUvRect(atlas, move.to),
+		/// to update everything referencing the images before drawing with the command buffer.
+		/// @return The moves, empty when the atlas did not get more compact
+		std::vector<AtlasMove> update(SDL_GPUCommandBuffer* commandBuffer, SDL_GPUTexture* texture, ImageAtlas& atlas, size_t maxMoves = DefaultMaxMoves);
+
+	private:
+		GpuTexture staging_;
+		int stagingWidth_ = 0;
+		int stagingHeight_ = 0;
+	};
+
+}
+
+#endif
@@ -0,0 +1,136 @@
+#include "atlasmanager.h"
+#include "sdlexception.h"
+#include "spriterenderer.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace sdl {
+
+	AtlasManager::AtlasManager(SDL_GPUDevice* gpuDevice, const AtlasManagerConfig& config)
+		: gpuDevice_{gpuDevice}
+		, config_{config}
+		, uploadQueue_{gpuDevice} {
+
+		if (config_.initialPageSize < 1 || config_.maxPageSize < config_.initialPageSize) {
+			throw std::invalid_argument{fmt::format("Invalid atlas page sizes, initial {} and max {}", config_.initialPageSize, config_.maxPageSize)};
+		}
+	}
+
+	AtlasImage AtlasManager::add(SDL_Surface* surface, int border) {
+		SdlSurface converted;
+		if (surface->format != SDL_PIXELFORMAT_RGBA32) {
+			converted.reset(SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGBA32));
+			if (!converted) {
+				throw sdl::SdlException{"[AtlasManager] Failed to convert surface to RGBA32"};
+			}
+			surface = converted.get();
+		}
+
+		const int paddedSize = std::max(surface->w, surface->h) + 2 * border;
+		if (paddedSize > config_.maxPageSize) {
+			throw std::invalid_argument{fmt::format("Image of {}x{} with border {} is larger than the max page size {}",
+				surface->w, surface->h, border, config_.maxPageSize)};
+		}
+
+		auto insert = [&](size_t page) -> std::optional<AtlasImage> {
+			auto handle = pages_[page].atlas.insert(surface->w, surface->h, border);
+			if (!handle) {
+				return std::nullopt;
+			}
+			auto rect = pages_[page].atlas.getRect(*handle);
+			uploadQueue_.uploadPixels(surface->pixels, surface->pitch, pages_[page].texture.get(), *rect);
+			return AtlasImage{static_cast<uint32_t>(page), *handle};
+		};
+
+		for (size_t page = 0; page < pages_.size(); ++page) {
+			if (auto image = insert(page)) {
+				return *image;
+			}
+		}
+		for (size_t page = 0; page < pages_.size(); ++page) {
+			while (pages_[page].atlas.getWidth() < config_.maxPageSize) {
+				growPage(pages_[page], std::min(pages_[page].atlas.getWidth() * 2, config_.maxPageSize));
+				if (auto image = insert(page)) {
+					return *image;
+				}
+			}
+		}
+
+		const int size = std::min(std::max(config_.initialPageSize, static_cast<int>(std::bit_ceil(static_cast<unsigned>(paddedSize)))), config_.maxPageSize);
+		pages_.push_back(Page{
+			.atlas = ImageAtlas{size, size, config_.packing},
+			.texture = createTexture(size, size)
+		});
+		return *insert(pages_.size() - 1);
+	}
+
+	bool AtlasManager::remove(AtlasImage image) {
+		return image.page < pages_.size() && pages_[image.page].atlas.remove(image.handle);
+	}
+
+	std::optional<AtlasLocation> AtlasManager::find(AtlasImage image) const {
+		if (image.page >= pages_.size()) {
+			return std::nullopt;
+		}
+		const auto& atlas = pages_[image.page].atlas;
+		if (auto rect = atlas.getRect(image.handle)) {
+			return AtlasLocation{
+				.page = image.page,
+				.rect = *rect,
+				.uvRect = atlasUvRect(atlas, *rect)
+			};
+		}
+		return std::nullopt;
+	}
+
+	void AtlasManager::record(SDL_GPUCommandBuffer* commandBuffer) {
+		uploadQueue_.record(commandBuffer);
+	}
+
+	GpuFence AtlasManager::submit() {
+		return uploadQueue_.submit();
+	}
+
+	GpuTexture AtlasManager::createTexture(int width, int height) {
+		return createGpuTexture(gpuDevice_, SDL_GPUTextureCreateInfo{
+			.type = SDL_GPU_TEXTURETYPE_2D,
+			.format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
+			.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER,
+			.width = static_cast<Uint32>(width),
+			.height = static_cast<Uint32>(height),
+			.layer_count_or_depth = 1,
+			.num_levels = 1,
+		});
+	}
+
+	void AtlasManager::growPage(Page& page, int size) {
+		const int oldWidth = page.atlas.getWidth();
+		const int oldHeight = page.atlas.getHeight();
+		auto texture = createTexture(size, size);
+
+		// The uploads queued to the old texture are recorded before the copy, and the ones queued after
+		// this go to the new texture, so they can not be overwritten by the copy.
+		SDL_GPUCommandBuffer* commandBuffer = SDL_AcquireGPUCommandBuffer(gpuDevice_);
+		if (!commandBuffer) {
+			throw sdl::SdlException{"[AtlasManager] Failed to acquire command buffer"};
+		}
+		uploadQueue_.record(commandBuffer);
+		gpuCopyPass(commandBuffer, [&](SDL_GPUCopyPass* copyPass) {
+			const SDL_GPUTextureLocation source{.texture = page.texture.get()};
+			const SDL_GPUTextureLocation destination{.texture = texture.get()};
+			SDL_CopyGPUTextureToTexture(copyPass, &source, &destination, oldWidth, oldHeight, 1, false);
+		});
+		if (!SDL_SubmitGPUCommandBuffer(commandBuffer)) {
+			throw sdl::SdlException{"[AtlasManager] Failed to submit command buffer"};
+		}
+
+		// SDL releases the old texture when the GPU is done with it.
+		page.texture = std::move(texture);
+		page.atlas.grow(size, size);
+	}
+
+}
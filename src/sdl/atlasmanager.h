@@ -0,0 +1,104 @@
+#ifndef CPPSDL3_SDL_ATLASMANAGER_H
+#define CPPSDL3_SDL_ATLASMANAGER_H
+
+#include "gpu.h"
+#include "gpuutil.h"
+#include "imageatlas.h"
+
+#include <SDL3/SDL_gpu.h>
+#include <SDL3/SDL_surface.h>
+#include <glm/glm.hpp>
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace sdl {
+
+	struct AtlasManagerConfig {
+		int initialPageSize = 512;	///< Size of a new page, larger for images not fitting
+		int maxPageSize = 2048;		///< A page is grown by doubling its size up to this size
+		AtlasPacking packing = AtlasPacking::MaxRects;
+	};
+
+	/// @brief An image added to an AtlasManager.
+	struct AtlasImage {
+		uint32_t page = 0;
+		AtlasHandle handle;
+
+		friend auto operator<=>(const AtlasImage&, const AtlasImage&) = default;
+	};
+
+	/// @brief Where an image is, valid until the next add, which may grow the page.
+	struct AtlasLocation {
+		size_t page = 0;
+		SDL_Rect rect{};
+		glm::vec4 uvRect{};	///< (u0, v0, u1, v1), see atlasUvRect
+	};
+
+	/// @brief Atlas of RGBA32 images spread over pages, each page an ImageAtlas with its own texture.
+	/// When no page has room, a page below the max page size is grown, its old content copied to the
+	/// larger texture on the GPU, otherwise a new page is opened. Adding only fails for images larger
+	/// than the max page size.
+	/// The uploads are queued, call record() or submit() before drawing with the page textures.
+	class AtlasManager {
+	public:
+		explicit AtlasManager(SDL_GPUDevice* gpuDevice, const AtlasManagerConfig& config = {});
+
+		AtlasManager(const AtlasManager&) = delete;
+		AtlasManager& operator=(const AtlasManager&) = delete;
+
+		/// @brief Reserves room for the surface and queues its upload. Throws std::invalid_argument if the
+		/// surface with its border is larger than the max page size.
+		AtlasImage add(SDL_Surface* surface, int border = 0);
+
+		/// @brief Frees the room of the image. Returns false if the image is not in the atlas.
+		bool remove(AtlasImage image);
+
+		[[nodiscard]]
+		std::optional<AtlasLocation> find(AtlasImage image) const;
+
+		/// @brief Texture of the page, is replaced when the page grows.
+		[[nodiscard]]
+		SDL_GPUTexture* getTexture(size_t page) const noexcept {
+			return pages_[page].texture.get();
+		}
+
+		[[nodiscard]]
+		const ImageAtlas& getAtlas(size_t page) const noexcept {
+			return pages_[page].atlas;
+		}
+
+		[[nodiscard]]
+		size_t getPageCount() const noexcept {
+			return pages_.size();
+		}
+
+		/// @brief Records the queued uploads on the command buffer, e.g. the frame command buffer.
+		void record(SDL_GPUCommandBuffer* commandBuffer);
+
+		/// @brief Records the queued uploads on a new command buffer and submits it.
+		GpuFence submit();
+
+	private:
+		struct Page {
+			ImageAtlas atlas;
+			GpuTexture texture;
+		};
+
+		GpuTexture createTexture(int width, int height);
+
+		// Grows the page to the size and copies the content of the old texture.
+		void growPage(Page& page, int size);
+
+		SDL_GPUDevice* gpuDevice_ = nullptr;
+		AtlasManagerConfig config_;
+		UploadQueue uploadQueue_;
+		std::vector<Page> pages_;
+	};
+
+}
+
+#endif
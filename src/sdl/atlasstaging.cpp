@@ -0,0 +1,105 @@
+#include "atlasstaging.h"
+#include "gpuutil.h"
+#include "sdlexception.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace sdl {
+
+	namespace {
+
+		// Offset alignment of texture uploads, the strictest of the backends (D3D12).
+		constexpr size_t TextureAlignment = 512;
+		constexpr size_t MinCapacity = 64 * 1024;
+
+	}
+
+	AtlasStaging::AtlasStaging(SDL_GPUDevice* gpuDevice)
+		: gpuDevice_{gpuDevice} {
+	}
+
+	SDL_Rect AtlasStaging::blit(SDL_Surface* surface, SDL_GPUTexture* texture, ImageAtlas& imageAtlas, int border) {
+		auto rect = imageAtlas.add(surface->w, surface->h, border);
+		if (!rect) {
+			throw std::runtime_error{"Failed to blit surface to atlas"};
+		}
+		write(surface, texture, *rect);
+		return *rect;
+	}
+
+	void AtlasStaging::write(SDL_Surface* surface, SDL_GPUTexture* texture, const SDL_Rect& rect) {
+		SdlSurface converted;
+		if (surface->format != SDL_PIXELFORMAT_RGBA32) {
+			converted.reset(SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGBA32));
+			if (!converted) {
+				throw sdl::SdlException{"[AtlasStaging] Failed to convert surface to RGBA32"};
+			}
+			surface = converted.get();
+		}
+
+		const size_t rowBytes = static_cast<size_t>(rect.w) * 4;
+		if (rowBytes == 0 || rect.h <= 0) {
+			return;
+		}
+		const size_t offset = (staging_.size() + TextureAlignment - 1) / TextureAlignment * TextureAlignment;
+		staging_.resize(offset + rowBytes * rect.h);
+		auto source = static_cast<const std::byte*>(surface->pixels);
+		for (int row = 0; row < rect.h; ++row) {
+			std::memcpy(staging_.data() + offset + row * rowBytes, source + row * surface->pitch, rowBytes);
+		}
+		regions_.push_back(Region{
+			.texture = texture,
+			.rect = rect,
+			.offset = static_cast<Uint32>(offset)
+		});
+	}
+
+	void AtlasStaging::flush(SDL_GPUCommandBuffer* commandBuffer) {
+		if (regions_.empty()) {
+			return;
+		}
+
+		if (capacity_ < staging_.size()) {
+			capacity_ = computeCapacity(capacity_, staging_.size(), BufferGrowth{
+				.policy = GrowthPolicy::PowerOfTwo,
+				.minSize = MinCapacity
+			});
+			transferBuffer_ = createGpuTransferBuffer(gpuDevice_, SDL_GPUTransferBufferCreateInfo{
+				.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+				.size = static_cast<Uint32>(capacity_)
+			});
+		}
+
+		// Cycled, so the upload of the previous flush may still be in flight.
+		auto mapped = SDL_MapGPUTransferBuffer(gpuDevice_, transferBuffer_.get(), true);
+		if (!mapped) {
+			throw sdl::SdlException{"[AtlasStaging] Failed to map transfer buffer"};
+		}
+		std::memcpy(mapped, staging_.data(), staging_.size());
+		SDL_UnmapGPUTransferBuffer(gpuDevice_, transferBuffer_.get());
+
+		gpuCopyPass(commandBuffer, [&](SDL_GPUCopyPass* copyPass) {
+			for (const auto& region : regions_) {
+				const SDL_GPUTextureTransferInfo source{
+					.transfer_buffer = transferBuffer_.get(),
+					.offset = region.offset,
+					.pixels_per_row = static_cast<Uint32>(region.rect.w),
+					.rows_per_layer = static_cast<Uint32>(region.rect.h)
+				};
+				const SDL_GPUTextureRegion destination{
+					.texture = region.texture,
+					.x = static_cast<Uint32>(region.rect.x),
+					.y = static_cast<Uint32>(region.rect.y),
+					.w = static_cast<Uint32>(region.rect.w),
+					.h = static_cast<Uint32>(region.rect.h),
+					.d = 1
+				};
+				SDL_UploadToGPUTexture(copyPass, &source, &destination, false);
+			}
+		});
+		regions_.clear();
+		staging_.clear();
+	}
+
+}
@@ -0,0 +1,65 @@
+#ifndef CPPSDL3_SDL_ATLASSTAGING_H
+#define CPPSDL3_SDL_ATLASSTAGING_H
+
+#include "gpu.h"
+#include "imageatlas.h"
+
+#include <SDL3/SDL_gpu.h>
+#include <SDL3/SDL_surface.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace sdl {
+
+	/// @brief Collects the pixels of atlas blits on the CPU and uploads all dirty regions once per frame.
+	/// flush() copies the staged pixels into one persistent transfer buffer and records one copy pass,
+	/// with one SDL_UploadToGPUTexture per region. Many images added in a frame cost one submission,
+	/// instead of one transfer buffer and one submission each as with blitToGpuTexture.
+	/// The textures must stay alive until the next flush().
+	class AtlasStaging {
+	public:
+		explicit AtlasStaging(SDL_GPUDevice* gpuDevice);
+
+		AtlasStaging(const AtlasStaging&) = delete;
+		AtlasStaging& operator=(const AtlasStaging&) = delete;
+
+		/// @brief Reserves room for the surface in the atlas and stages its pixels for that rect of the texture.
+		/// Throws std::runtime_error if the atlas is full.
+		SDL_Rect blit(SDL_Surface* surface, SDL_GPUTexture* texture, ImageAtlas& imageAtlas, int border = 0);
+
+		/// @brief Stages the pixels of the surface, converted to RGBA32, for the rect of the texture.
+		void write(SDL_Surface* surface, SDL_GPUTexture* texture, const SDL_Rect& rect);
+
+		/// @brief Records the uploads of all dirty regions on the command buffer, e.g. the frame command buffer.
+		void flush(SDL_GPUCommandBuffer* commandBuffer);
+
+		/// @brief Number of regions waiting for flush().
+		[[nodiscard]]
+		size_t getDirtyCount() const noexcept {
+			return regions_.size();
+		}
+
+		/// @brief Bytes waiting for flush(), including alignment padding.
+		[[nodiscard]]
+		size_t getStagedBytes() const noexcept {
+			return staging_.size();
+		}
+
+	private:
+		struct Region {
+			SDL_GPUTexture* texture = nullptr;
+			SDL_Rect rect{};
+			Uint32 offset = 0;
+		};
+
+		SDL_GPUDevice* gpuDevice_ = nullptr;
+		std::vector<std::byte> staging_;
+		std::vector<Region> regions_;
+		GpuTransferBuffer transferBuffer_;
+		size_t capacity_ = 0;
+	};
+
+}
+
+#endif
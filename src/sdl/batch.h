@@ -2,23 +2,47 @@
 #define CPPSDL3_SDL_BATCH_H
 
 #include "gpu.h"
+#include "drawcommand.h"
+#include "meshoptimize.h"
+#include "staticmesh.h"
+#include "vertextransform.h"
 
 #include <vector>
+#include <memory_resource>
 #include <initializer_list>
 #include <cstdint>
 #include <concepts>
 #include <span>
 #include <algorithm>
+#include <optional>
+#include <limits>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
 
 namespace sdl {
 
-	template <VertexType Vertex>
+	/// @brief Vertices and indices together with the draw commands using them.
+	/// With 16-bit indices a new draw range, with its own vertex offset, is started
+	/// automatically when the indices of a shape would overflow the index type.
+	template <VertexType Vertex, IndexType Index = uint32_t>
 	class Batch {
 	public:
+		static constexpr uint32_t MaxIndex = std::numeric_limits<Index>::max();
+
 		Batch() = default;
-		
+
+		/// @brief All vertices, indices and commands are allocated from the memory resource, e.g. a FrameArena.
+		/// The resource must outlive the batch.
+		explicit Batch(std::pmr::memory_resource* resource)
+			: vertices_{resource}
+			, indices_{resource}
+			, commands_{resource} {
+		}
+
 		void startBatch() {
 			index_ = static_cast<uint32_t>(vertices_.size());
+			shapeIndexStart_ = indices_.size();
 		}
 
 		void pushBack(const Vertex& vertex) {
@@ -33,17 +57,229 @@ namespace sdl {
 			insert(std::span<const Vertex>(list.begin(), list.size()));
 		}
 
-		void pushBackIndex(uint32_t index) {
-			indices_.push_back(index + index_);
+		/// @brief Inserts the vertices with the positions transformed by the matrix.
+		void insertTransformed(std::span<const Vertex> span, const glm::mat4& matrix) requires TransformableVertex<Vertex> {
+			if (span.empty()) {
+				return;
+			}
+			const size_t first = vertices_.size();
+			insert(span);
+			transformPositions(matrix, &vertices_[first].position, sizeof(Vertex), span.size());
+		}
+
+		void insertTransformed(std::span<const Vertex> span, const glm::mat3x2& matrix) requires TransformableVertex<Vertex> {
+			if (span.empty()) {
+				return;
+			}
+			const size_t first = vertices_.size();
+			insert(span);
+			transformPositions(matrix, &vertices_[first].position, sizeof(Vertex), span.size());
+		}
+
+		/// @brief Inserts the vertices with the positions transformed and the colors multiplied component-wise.
+		void insertTransformed(std::span<const Vertex> span, const glm::mat4& matrix, const glm::vec4& colorMultiplier)
+			requires TransformableVertex<Vertex> && ColorVertex<Vertex> {
+
+			const size_t first = vertices_.size();
+			insertTransformed(span, matrix);
+			multiplyColors(first, colorMultiplier);
+		}
+
+		void insertTransformed(std::span<const Vertex> span, const glm::mat3x2& matrix, const glm::vec4& colorMultiplier)
+			requires TransformableVertex<Vertex> && ColorVertex<Vertex> {
+
+			const size_t first = vertices_.size();
+			insertTransformed(span, matrix);
+			multiplyColors(first, colorMultiplier);
+		}
+
+		void pushBackIndex(Index index) {
+			fitIndex(index);
+			indices_.push_back(static_cast<Index>(index + index_ - vertexOffset_));
+			addToCommand(1);
 		}
 
-		void insertIndices(std::span<const uint32_t> indices) {
+		void insertIndices(std::span<const Index> indices) {
+			if (indices.empty()) {
+				return;
+			}
+			fitIndex(*std::max_element(indices.begin(), indices.end()));
+			const uint32_t offset = index_ - vertexOffset_;
 			std::transform(indices.begin(), indices.end(), std::back_inserter(indices_),
-				[this](uint32_t index) { return index + index_; });
+				[offset](Index index) { return static_cast<Index>(index + offset); });
+			addToCommand(indices.size());
 		}
 
-		void insertIndices(std::initializer_list<uint32_t> localIndices) {
-			insertIndices(std::span<const uint32_t>(localIndices.begin(), localIndices.size()));
+		void insertIndices(std::initializer_list<Index> localIndices) {
+			insertIndices(std::span<const Index>(localIndices.begin(), localIndices.size()));
+		}
+
+		/// @brief Appends the vertices, indices and commands of another batch. The indices are rebased
+		/// to the vertices already in this batch, the same way as insertIndices() after startBatch().
+		void append(const Batch& batch) {
+			startBatch();
+			insert(batch.vertices_);
+
+			for (auto command : batch.commands_) {
+				auto first = batch.indices_.begin() + command.firstIndex;
+				auto last = first + command.indexCount;
+
+				const uint32_t base = index_ + static_cast<uint32_t>(command.vertexOffset);
+				if constexpr (MaxIndex < std::numeric_limits<uint32_t>::max()) {
+					if (first != last && base - vertexOffset_ + *std::max_element(first, last) > MaxIndex) {
+						vertexOffset_ = base;
+					}
+				}
+				const uint32_t offset = base - vertexOffset_;
+
+				command.firstIndex = static_cast<uint32_t>(indices_.size());
+				command.vertexOffset = static_cast<Sint32>(vertexOffset_);
+				std::transform(first, last, std::back_inserter(indices_),
+					[offset](Index index) { return static_cast<Index>(index + offset); });
+				addCommand(command);
+			}
+			shapeIndexStart_ = indices_.size();
+		}
+
+		/// @brief Sets the state used by indices added from now on.
+		void setDrawState(const DrawState& state) {
+			state_ = state;
+		}
+
+		const DrawState& getDrawState() const noexcept {
+			return state_;
+		}
+
+		/// @brief Sets the sort key used by indices added from now on. Commands are drawn in
+		/// increasing key order after sort(), use different keys where the draw order matters.
+		void setSortKey(uint32_t sortKey) noexcept {
+			sortKey_ = sortKey;
+		}
+
+		/// @brief Orders the commands by sort key and state and merges the commands sharing state.
+		/// The indices are rewritten to follow the new command order.
+		void sort() {
+			if (commands_.size() < 2) {
+				return;
+			}
+			std::stable_sort(commands_.begin(), commands_.end(), drawCommandLess);
+
+			std::pmr::vector<Index> indices{indices_.get_allocator()};
+			indices.reserve(indices_.size());
+			std::pmr::vector<DrawCommand> commands{commands_.get_allocator()};
+			for (auto command : commands_) {
+				auto first = indices_.begin() + command.firstIndex;
+				command.firstIndex = static_cast<uint32_t>(indices.size());
+				indices.insert(indices.end(), first, first + command.indexCount);
+				if (!commands.empty() && canMergeDrawCommands(commands.back(), command)) {
+					commands.back().indexCount += command.indexCount;
+				} else {
+					commands.push_back(command);
+				}
+			}
+			indices_ = std::move(indices);
+			commands_ = std::move(commands);
+			shapeIndexStart_ = indices_.size();
+		}
+
+		/// @brief Removes duplicate and unused vertices, reorders the triangles of each command for the
+		/// post-transform vertex cache and then the vertices in the order they are first used.
+		/// Meant for meshes built once and drawn many times. The commands must draw triangle lists, and the
+		/// triangles within a command may change draw order, so overlapping blended triangles should use
+		/// separate commands. Vertices are equal when their bytes are equal.
+		void optimize() {
+			// Commands sharing a vertex offset share a vertex range and are optimized together.
+			std::vector<uint32_t> vertexOffsets;
+			std::vector<size_t> groups(commands_.size());
+			for (size_t i = 0; i < commands_.size(); ++i) {
+				auto offset = static_cast<uint32_t>(commands_[i].vertexOffset);
+				auto it = std::find(vertexOffsets.begin(), vertexOffsets.end(), offset);
+				groups[i] = static_cast<size_t>(it - vertexOffsets.begin());
+				if (it == vertexOffsets.end()) {
+					vertexOffsets.push_back(offset);
+				}
+			}
+
+			auto hash = [this](uint32_t vertex) {
+				return std::hash<std::string_view>{}(std::string_view{reinterpret_cast<const char*>(&vertices_[vertex]), sizeof(Vertex)});
+			};
+			auto equal = [this](uint32_t left, uint32_t right) {
+				return std::memcmp(&vertices_[left], &vertices_[right], sizeof(Vertex)) == 0;
+			};
+
+			std::pmr::vector<Vertex> vertices{vertices_.get_allocator()};
+			vertices.reserve(vertices_.size());
+			std::vector<uint32_t> groupIndices;
+			std::vector<uint32_t> uniqueVertices;
+			vertexOffset_ = 0;
+
+			for (size_t group = 0; group < vertexOffsets.size(); ++group) {
+				// Number the unique vertices of the group from 0.
+				std::unordered_map<uint32_t, uint32_t, decltype(hash), decltype(equal)> unique{vertices_.size(), hash, equal};
+				groupIndices.clear();
+				uniqueVertices.clear();
+				for (size_t i = 0; i < commands_.size(); ++i) {
+					if (groups[i] != group) {
+						continue;
+					}
+					const auto& command = commands_[i];
+					for (uint32_t j = command.firstIndex; j < command.firstIndex + command.indexCount; ++j) {
+						uint32_t vertex = indices_[j] + vertexOffsets[group];
+						auto [it, inserted] = unique.try_emplace(vertex, static_cast<uint32_t>(uniqueVertices.size()));
+						if (inserted) {
+							uniqueVertices.push_back(vertex);
+						}
+						groupIndices.push_back(it->second);
+					}
+				}
+
+				size_t position = 0;
+				for (size_t i = 0; i < commands_.size(); ++i) {
+					if (groups[i] == group) {
+						optimizeVertexCache(std::span{groupIndices}.subspan(position, commands_[i].indexCount), uniqueVertices.size());
+						position += commands_[i].indexCount;
+					}
+				}
+				auto order = optimizeVertexFetch(groupIndices, uniqueVertices.size());
+
+				vertexOffset_ = static_cast<uint32_t>(vertices.size());
+				for (uint32_t vertex : order) {
+					vertices.push_back(vertices_[uniqueVertices[vertex]]);
+				}
+				position = 0;
+				for (size_t i = 0; i < commands_.size(); ++i) {
+					if (groups[i] != group) {
+						continue;
+					}
+					auto& command = commands_[i];
+					for (uint32_t j = command.firstIndex; j < command.firstIndex + command.indexCount; ++j) {
+						indices_[j] = static_cast<Index>(groupIndices[position++]);
+					}
+					command.vertexOffset = static_cast<Sint32>(vertexOffset_);
+				}
+			}
+
+			vertices_ = std::move(vertices);
+			index_ = static_cast<uint32_t>(vertices_.size());
+			shapeIndexStart_ = indices_.size();
+		}
+
+		/// @brief Binds the vertex and index buffer holding this batch and draws all commands.
+		/// The render area is required if any command has a scissor, see drawCommands().
+		void draw(SDL_GPURenderPass* renderPass, const SDL_GPUBufferBinding& vertexBinding, const SDL_GPUBufferBinding& indexBinding,
+			const std::optional<SDL_Rect>& renderArea = std::nullopt) const {
+
+			SDL_BindGPUVertexBuffers(renderPass, 0, &vertexBinding, 1);
+			bindGpuIndexBuffer<Index>(renderPass, indexBinding);
+			drawCommands(renderPass, commands_, renderArea);
+		}
+
+		/// @brief Uploads the vertices and indices to immutable GPU buffers, recorded as a copy pass in the
+		/// command buffer. The returned mesh does not depend on the batch, which can be cleared afterwards.
+		[[nodiscard]]
+		StaticMesh bake(SDL_GPUDevice* gpuDevice, SDL_GPUCommandBuffer* commandBuffer) const {
+			return StaticMesh{gpuDevice, commandBuffer, std::as_bytes(vertices()), std::as_bytes(indices()),
+				gpuIndexElementSize<Index>(), commands_};
 		}
 
 		void reserve(size_t vertexCount, size_t indexCount) {
@@ -51,29 +287,100 @@ namespace sdl {
 			indices_.reserve(indexCount);
 		}
 
+		/// @brief Frees unused capacity. Batches refilled every frame should use clear() only and keep the capacity.
 		void shrinkToFit() {
 			vertices_.shrink_to_fit();
 			indices_.shrink_to_fit();
+			commands_.shrink_to_fit();
 		}
 
 		void clear() {
 			vertices_.clear();
 			indices_.clear();
+			commands_.clear();
+			state_ = {};
 			index_ = 0;
+			vertexOffset_ = 0;
+			shapeIndexStart_ = 0;
+			sortKey_ = 0;
 		}
 
 		std::span<const Vertex> vertices() const {
 			return vertices_;
 		}
 
-		std::span<const uint32_t> indices() const {
+		std::span<const Index> indices() const {
 			return indices_;
 		}
 
+		std::span<const DrawCommand> commands() const {
+			return commands_;
+		}
+
 	private:
-		std::vector<Vertex> vertices_;
-		std::vector<uint32_t> indices_;
+		// Starts a new draw range at the current shape if the local index does not fit the index type.
+		void fitIndex(Index localIndex) {
+			if constexpr (MaxIndex < std::numeric_limits<uint32_t>::max()) {
+				if (index_ - vertexOffset_ + localIndex <= MaxIndex) {
+					return;
+				}
+				const uint32_t delta = index_ - vertexOffset_;
+				vertexOffset_ = index_;
+
+				// Move the indices already added for the current shape to the new range.
+				for (size_t i = shapeIndexStart_; i < indices_.size(); ++i) {
+					indices_[i] = static_cast<Index>(indices_[i] - delta);
+				}
+				const auto shapeStart = static_cast<uint32_t>(shapeIndexStart_);
+				for (auto it = commands_.rbegin(); it != commands_.rend() && it->firstIndex + it->indexCount > shapeStart; ++it) {
+					if (it->firstIndex >= shapeStart) {
+						it->vertexOffset = static_cast<Sint32>(vertexOffset_);
+					} else {
+						DrawCommand split = *it;
+						split.firstIndex = shapeStart;
+						split.indexCount = it->firstIndex + it->indexCount - shapeStart;
+						split.vertexOffset = static_cast<Sint32>(vertexOffset_);
+						it->indexCount = shapeStart - it->firstIndex;
+						commands_.insert(it.base(), split);
+						break;
+					}
+				}
+			}
+		}
+
+		void multiplyColors(size_t first, const glm::vec4& colorMultiplier) {
+			for (auto it = vertices_.begin() + first; it != vertices_.end(); ++it) {
+				multiplyColor(it->color, colorMultiplier);
+			}
+		}
+
+		void addToCommand(size_t indexCount) {
+			auto count = static_cast<uint32_t>(indexCount);
+			addCommand(DrawCommand{
+				.state = state_,
+				.firstIndex = static_cast<uint32_t>(indices_.size()) - count,
+				.indexCount = count,
+				.vertexOffset = static_cast<Sint32>(vertexOffset_),
+				.sortKey = sortKey_
+			});
+		}
+
+		void addCommand(const DrawCommand& command) {
+			if (!commands_.empty() && canMergeDrawCommands(commands_.back(), command)) {
+				commands_.back().indexCount += command.indexCount;
+			} else {
+				commands_.push_back(command);
+			}
+		}
+
+		std::pmr::vector<Vertex> vertices_;
+		std::pmr::vector<Index> indices_;
+		std::pmr::vector<DrawCommand> commands_;
+		DrawState state_;
 		uint32_t index_ = 0;
+		uint32_t vertexOffset_ = 0;
+		size_t shapeIndexStart_ = 0;
+		uint32_t sortKey_ = 0;
 	};
 
 }
@@ -0,0 +1,94 @@
+#include "drawcommand.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <tuple>
+
+namespace sdl {
+
+	namespace {
+
+		bool operator==(const SDL_Rect& left, const SDL_Rect& right) noexcept {
+			return left.x == right.x && left.y == right.y && left.w == right.w && left.h == right.h;
+		}
+
+		auto toTuple(const DrawCommand& command) noexcept {
+			const auto& state = command.state;
+			auto scissor = state.scissor.value_or(SDL_Rect{});
+			return std::tuple{
+				command.sortKey,
+				reinterpret_cast<std::uintptr_t>(state.pipeline),
+				reinterpret_cast<std::uintptr_t>(state.texture),
+				reinterpret_cast<std::uintptr_t>(state.sampler),
+				state.scissor.has_value(),
+				scissor.x, scissor.y, scissor.w, scissor.h,
+				command.vertexOffset
+			};
+		}
+
+	}
+
+	bool operator==(const DrawState& left, const DrawState& right) noexcept {
+		return left.pipeline == right.pipeline
+			&& left.texture == right.texture
+			&& left.sampler == right.sampler
+			&& left.scissor.has_value() == right.scissor.has_value()
+			&& (!left.scissor || *left.scissor == *right.scissor);
+	}
+
+	bool drawCommandLess(const DrawCommand& left, const DrawCommand& right) noexcept {
+		return toTuple(left) < toTuple(right);
+	}
+
+	bool canMergeDrawCommands(const DrawCommand& first, const DrawCommand& second) noexcept {
+		return first.firstIndex + first.indexCount == second.firstIndex
+			&& first.vertexOffset == second.vertexOffset
+			&& first.sortKey == second.sortKey
+			&& first.state == second.state;
+	}
+
+	void drawCommands(SDL_GPURenderPass* renderPass, std::span<const DrawCommand> commands, const std::optional<SDL_Rect>& renderArea) {
+		// Without the render area a command without scissor would be clipped by the scissor of the previous command.
+		if (!renderArea && std::ranges::any_of(commands, [](const DrawCommand& command) { return command.state.scissor.has_value(); })) {
+			throw std::invalid_argument{"[drawCommands] renderArea is required when a command has a scissor"};
+		}
+
+		SDL_GPUGraphicsPipeline* pipeline = nullptr;
+		SDL_GPUTextureSamplerBinding samplerBinding{};
+		std::optional<SDL_Rect> scissor;
+
+		for (const auto& command : commands) {
+			if (command.indexCount == 0) {
+				continue;
+			}
+			const auto& state = command.state;
+			if (state.pipeline && state.pipeline != pipeline) {
+				pipeline = state.pipeline;
+				SDL_BindGPUGraphicsPipeline(renderPass, pipeline);
+			}
+			if (state.texture && (state.texture != samplerBinding.texture || state.sampler != samplerBinding.sampler)) {
+				samplerBinding = SDL_GPUTextureSamplerBinding{
+					.texture = state.texture,
+					.sampler = state.sampler
+				};
+				SDL_BindGPUFragmentSamplers(renderPass, 0, &samplerBinding, 1);
+			}
+			if (state.scissor) {
+				if (!scissor || !(*scissor == *state.scissor)) {
+					scissor = state.scissor;
+					SDL_SetGPUScissor(renderPass, &*scissor);
+				}
+			} else if (scissor) {
+				scissor.reset();
+				SDL_SetGPUScissor(renderPass, &*renderArea);
+			}
+			SDL_DrawGPUIndexedPrimitives(renderPass, command.indexCount, 1, command.firstIndex, command.vertexOffset, 0);
+		}
+		// Later draws in the same render pass must not be clipped by the scissor of the last command.
+		if (scissor) {
+			SDL_SetGPUScissor(renderPass, &*renderArea);
+		}
+	}
+
+}
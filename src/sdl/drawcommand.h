@@ -0,0 +1,54 @@
+#ifndef CPPSDL3_SDL_DRAWCOMMAND_H
+#define CPPSDL3_SDL_DRAWCOMMAND_H
+
+#include <SDL3/SDL_gpu.h>
+#include <SDL3/SDL_rect.h>
+
+#include <optional>
+#include <span>
+
+namespace sdl {
+
+	/// @brief GPU state used when drawing a range of indices.
+	/// A null pipeline or texture leaves the state bound by the caller untouched.
+	struct DrawState {
+		SDL_GPUGraphicsPipeline* pipeline = nullptr;
+		SDL_GPUTexture* texture = nullptr;
+		SDL_GPUSampler* sampler = nullptr;
+		std::optional<SDL_Rect> scissor;
+
+		friend bool operator==(const DrawState& left, const DrawState& right) noexcept;
+	};
+
+	/// @brief A range of indices drawn with the same state.
+	/// The vertex offset is added to each index, which lets 16-bit indices address larger buffers.
+	struct DrawCommand {
+		DrawState state;
+		Uint32 firstIndex = 0;
+		Uint32 indexCount = 0;
+		Sint32 vertexOffset = 0;
+		Uint32 sortKey = 0;
+	};
+
+	/// @brief True if second starts where first ends and both share state, sort key and vertex offset,
+	/// i.e. they can be drawn as one command.
+	[[nodiscard]]
+	bool canMergeDrawCommands(const DrawCommand& first, const DrawCommand& second) noexcept;
+
+	/// @brief Orders commands by sort key first and then by state, so equal state ends up adjacent.
+	[[nodiscard]]
+	bool drawCommandLess(const DrawCommand& left, const DrawCommand& right) noexcept;
+
+	/// @brief Binds the state and draws each command. State equal to the previous command is not rebound.
+	/// The vertex and index buffers must already be bound to the render pass.
+	/// @param renderPass The render pass to draw into
+	/// @param commands The commands to draw
+	/// @param renderArea Scissor restored when a command without scissor follows one with scissor and after the
+	/// last command, usually the full render target. Is required if any command has a scissor, else
+	/// std::invalid_argument is thrown.
+	void drawCommands(SDL_GPURenderPass* renderPass, std::span<const DrawCommand> commands,
+		const std::optional<SDL_Rect>& renderArea = std::nullopt);
+
+}
+
+#endif
@@ -0,0 +1,61 @@
+#include "framearena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace sdl {
+
+	FrameArena::FrameArena(size_t initialSize, std::pmr::memory_resource* upstream)
+		: upstream_{upstream} {
+
+		addBlock(std::max<size_t>(initialSize, 1));
+	}
+
+	FrameArena::~FrameArena() {
+		releaseBlocks();
+	}
+
+	void FrameArena::reset() {
+		if (blocks_.size() > 1) {
+			const size_t capacity = capacity_;
+			releaseBlocks();
+			addBlock(capacity);
+		}
+		offset_ = 0;
+		used_ = 0;
+	}
+
+	void* FrameArena::do_allocate(size_t bytes, size_t alignment) {
+		auto alignedOffset = [&](const Block& block) {
+			auto address = reinterpret_cast<std::uintptr_t>(block.data) + offset_;
+			return offset_ + (alignment - address % alignment) % alignment;
+		};
+
+		size_t offset = alignedOffset(blocks_.back());
+		if (offset + bytes > blocks_.back().size) {
+			addBlock(std::max(bytes + alignment, blocks_.back().size * 2));
+			offset = alignedOffset(blocks_.back());
+		}
+		used_ += offset + bytes - offset_;
+		offset_ = offset + bytes;
+		return blocks_.back().data + offset;
+	}
+
+	void FrameArena::addBlock(size_t size) {
+		blocks_.push_back(Block{
+			.data = static_cast<std::byte*>(upstream_->allocate(size, alignof(std::max_align_t))),
+			.size = size
+		});
+		capacity_ += size;
+		offset_ = 0;
+	}
+
+	void FrameArena::releaseBlocks() {
+		for (const auto& block : blocks_) {
+			upstream_->deallocate(block.data, block.size, alignof(std::max_align_t));
+		}
+		blocks_.clear();
+		capacity_ = 0;
+	}
+
+}
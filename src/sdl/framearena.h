@@ -0,0 +1,66 @@
+#ifndef CPPSDL3_SDL_FRAMEARENA_H
+#define CPPSDL3_SDL_FRAMEARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace sdl {
+
+	/// @brief Memory resource for allocations living at most one frame. Allocating bumps a pointer and
+	/// deallocating does nothing. When reset() finds the frame needed more than one block, the blocks are
+	/// replaced by one block of the total size. Frames using no more memory than the largest frame so far
+	/// therefore never allocate from the upstream resource.
+	class FrameArena : public std::pmr::memory_resource {
+	public:
+		static constexpr size_t DefaultInitialSize = 64 * 1024;
+
+		explicit FrameArena(size_t initialSize = DefaultInitialSize,
+			std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+		~FrameArena() override;
+
+		FrameArena(const FrameArena&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+
+		/// @brief Makes all memory available again. Everything allocated since the last reset must be destroyed.
+		void reset();
+
+		/// @brief Bytes allocated since the last reset, including alignment padding.
+		size_t getUsed() const noexcept {
+			return used_;
+		}
+
+		/// @brief Bytes allocated from the upstream resource.
+		size_t getCapacity() const noexcept {
+			return capacity_;
+		}
+
+	private:
+		struct Block {
+			std::byte* data = nullptr;
+			size_t size = 0;
+		};
+
+		void* do_allocate(size_t bytes, size_t alignment) override;
+
+		void do_deallocate(void*, size_t, size_t) override {
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+			return this == &other;
+		}
+
+		void addBlock(size_t size);
+		void releaseBlocks();
+
+		std::pmr::memory_resource* upstream_ = nullptr;
+		std::vector<Block> blocks_;
+		size_t offset_ = 0;
+		size_t used_ = 0;
+		size_t capacity_ = 0;
+	};
+
+}
+
+#endif
@@ -0,0 +1,139 @@
+#include "frameprofiler.h"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace sdl {
+
+	namespace {
+
+		float toMilliseconds(FrameProfiler::Clock::duration duration) {
+			return std::chrono::duration<float, std::milli>{duration}.count();
+		}
+
+		void showHistory(const char* label, const ProfilerHistory& history) {
+			const auto values = history.values();
+			if (values.empty()) {
+				ImGui::Text("%-8s -", label);
+				return;
+			}
+			ImGui::Text("%-8s %6.2f ms  p50 %6.2f  p95 %6.2f  p99 %6.2f", label,
+				history.latest(), history.percentile(0.50f), history.percentile(0.95f), history.percentile(0.99f));
+			ImGui::PushID(label);
+			ImGui::PlotHistogram("##histogram", values.data(), static_cast<int>(values.size()), static_cast<int>(history.getOffset()),
+				nullptr, 0.f, std::max(history.percentile(0.99f) * 1.25f, 1.f), ImVec2{-1.f, 40.f});
+			ImGui::PopID();
+		}
+
+	}
+
+	ProfilerHistory::ProfilerHistory(size_t size)
+		: values_(std::max<size_t>(size, 1)) {
+	}
+
+	void ProfilerHistory::push(float milliseconds) {
+		values_[next_] = milliseconds;
+		next_ = (next_ + 1) % values_.size();
+		count_ = std::min(count_ + 1, values_.size());
+	}
+
+	float ProfilerHistory::percentile(float fraction) const {
+		if (count_ == 0) {
+			return 0.f;
+		}
+		std::vector<float> sorted{values_.begin(), values_.begin() + count_};
+		auto index = static_cast<size_t>(std::ceil(std::clamp(fraction, 0.f, 1.f) * count_));
+		auto nth = sorted.begin() + std::clamp<size_t>(index, 1, count_) - 1;
+		std::nth_element(sorted.begin(), nth, sorted.end());
+		return *nth;
+	}
+
+	float ProfilerHistory::latest() const noexcept {
+		return count_ == 0 ? 0.f : values_[(next_ + values_.size() - 1) % values_.size()];
+	}
+
+	FrameProfiler::Scope::~Scope() {
+		profiler_.sections_[section_].current += Clock::now() - start_;
+	}
+
+	FrameProfiler::FrameProfiler(size_t historySize)
+		: historySize_{historySize}
+		, frameTimes_{historySize}
+		, cpuTimes_{historySize}
+		, gpuTimes_{historySize} {
+	}
+
+	void FrameProfiler::beginFrame() {
+		const auto now = Clock::now();
+		if (frameStart_ != Clock::time_point{}) {
+			frameTimes_.push(toMilliseconds(now - frameStart_));
+		}
+		frameStart_ = now;
+		inFrame_ = true;
+	}
+
+	void FrameProfiler::endFrame() {
+		if (!inFrame_) {
+			return;
+		}
+		inFrame_ = false;
+		cpuTimes_.push(toMilliseconds(Clock::now() - frameStart_));
+		for (auto& section : sections_) {
+			section.history.push(toMilliseconds(section.current));
+			section.current = {};
+		}
+	}
+
+	FrameProfiler::Scope FrameProfiler::scope(const std::string& name) {
+		auto it = std::ranges::find(sections_, name, &Section::name);
+		if (it == sections_.end()) {
+			sections_.push_back(Section{
+				.name = name,
+				.history = ProfilerHistory{historySize_}
+			});
+			it = sections_.end() - 1;
+		}
+		return Scope{*this, static_cast<size_t>(it - sections_.begin())};
+	}
+
+	void FrameProfiler::gpuSubmitted() {
+		submitted_.push_back(Clock::now());
+	}
+
+	void FrameProfiler::gpuFinished(size_t count) {
+		const auto now = Clock::now();
+		for (; count > 0 && !submitted_.empty(); --count) {
+			gpuTimes_.push(toMilliseconds(now - submitted_.front()));
+			submitted_.pop_front();
+		}
+	}
+
+	std::vector<std::string> FrameProfiler::getSectionNames() const {
+		std::vector<std::string> names;
+		for (const auto& section : sections_) {
+			names.push_back(section.name);
+		}
+		return names;
+	}
+
+	const ProfilerHistory* FrameProfiler::getSectionTimes(const std::string& name) const {
+		auto it = std::ranges::find(sections_, name, &Section::name);
+		return it == sections_.end() ? nullptr : &it->history;
+	}
+
+	void FrameProfiler::showWindow(bool& open) const {
+		ImGui::SetNextWindowSize({420.f, 480.f}, ImGuiCond_FirstUseEver);
+		ImGui::Window("Frame Profiler", &open, [&]() {
+			showHistory("Frame", frameTimes_);
+			showHistory("CPU", cpuTimes_);
+			showHistory("GPU", gpuTimes_);
+			ImGui::SeparatorText("CPU sections");
+			for (const auto& section : sections_) {
+				showHistory(section.name.c_str(), section.history);
+			}
+		});
+	}
+
+}
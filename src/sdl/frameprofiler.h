@@ -0,0 +1,137 @@
+#ifndef CPPSDL3_SDL_FRAMEPROFILER_H
+#define CPPSDL3_SDL_FRAMEPROFILER_H
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace sdl {
+
+	/// @brief Fixed size history of the latest samples, in milliseconds.
+	class ProfilerHistory {
+	public:
+		explicit ProfilerHistory(size_t size);
+
+		void push(float milliseconds);
+
+		/// @brief Value at the percentile, e.g. 0.95, of the samples in the history. Zero if empty.
+		[[nodiscard]]
+		float percentile(float fraction) const;
+
+		[[nodiscard]]
+		float latest() const noexcept;
+
+		/// @brief The samples in ring order, starting at getOffset(), e.g. for ImGui::PlotHistogram.
+		[[nodiscard]]
+		std::span<const float> values() const noexcept {
+			return {values_.data(), count_};
+		}
+
+		[[nodiscard]]
+		size_t getOffset() const noexcept {
+			return count_ < values_.size() ? 0 : next_;
+		}
+
+	private:
+		std::vector<float> values_;
+		size_t next_ = 0;
+		size_t count_ = 0;
+	};
+
+	/// @brief Measures where the frame time goes, without an external profiler.
+	/// CPU sections are timed with scoped markers. GPU time is the time from submitting a frame until
+	/// its fence is seen signaled. It is only observed once per frame, so it is an upper bound with
+	/// frame granularity. sdl::Window feeds its own profiler, see Window::getFrameProfiler().
+	class FrameProfiler {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		static constexpr size_t DefaultHistorySize = 240;
+
+		/// @brief Adds the time from construction to destruction to the section of the current frame.
+		class Scope {
+		public:
+			Scope(FrameProfiler& profiler, size_t section) noexcept
+				: profiler_{profiler}
+				, section_{section}
+				, start_{Clock::now()} {
+			}
+
+			~Scope();
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		private:
+			FrameProfiler& profiler_;
+			size_t section_;
+			Clock::time_point start_;
+		};
+
+		explicit FrameProfiler(size_t historySize = DefaultHistorySize);
+
+		void beginFrame();
+
+		void endFrame();
+
+		/// @brief Times the enclosing scope as the named section. The same name may be used many times per frame.
+		[[nodiscard]]
+		Scope scope(const std::string& name);
+
+		/// @brief Call when a frame whose fence will be tracked has been submitted.
+		void gpuSubmitted();
+
+		/// @brief Call with the number of submitted frames seen finished, in submission order.
+		void gpuFinished(size_t count);
+
+		/// @brief Time between the start of two frames, including waiting for vsync and sleeping.
+		[[nodiscard]]
+		const ProfilerHistory& getFrameTimes() const noexcept {
+			return frameTimes_;
+		}
+
+		/// @brief Time between beginFrame and endFrame.
+		[[nodiscard]]
+		const ProfilerHistory& getCpuTimes() const noexcept {
+			return cpuTimes_;
+		}
+
+		[[nodiscard]]
+		const ProfilerHistory& getGpuTimes() const noexcept {
+			return gpuTimes_;
+		}
+
+		/// @brief Names of the sections, in the order they were first used.
+		[[nodiscard]]
+		std::vector<std::string> getSectionNames() const;
+
+		/// @brief History of the named section, or nullptr if it was never used.
+		[[nodiscard]]
+		const ProfilerHistory* getSectionTimes(const std::string& name) const;
+
+		/// @brief Draws an ImGui window with histograms and p50/p95/p99 of the frame, CPU, GPU and section times.
+		void showWindow(bool& open) const;
+
+	private:
+		struct Section {
+			std::string name;
+			ProfilerHistory history;
+			Clock::duration current{};
+		};
+
+		size_t historySize_ = DefaultHistorySize;
+		ProfilerHistory frameTimes_;
+		ProfilerHistory cpuTimes_;
+		ProfilerHistory gpuTimes_;
+		std::vector<Section> sections_;
+		std::deque<Clock::time_point> submitted_;
+		Clock::time_point frameStart_{};
+		bool inFrame_ = false;
+	};
+
+}
+
+#endif
@@ -2,6 +2,8 @@
 #define CPPSDL3_SDL_GPU_H
 
 #include "sdlexception.h"
+#include "gpumemory.h"
+#include "gpureleasequeue.h"
 
 #include <SDL3/SDL_gpu.h>
 #include <spdlog/spdlog.h>
@@ -10,10 +12,12 @@
 #include <span>
 #include <ranges>
 #include <memory>
+#include <optional>
 
 namespace sdl {
 
-	/// @brief Custom deleter for GPU resources that requires SDL_GPUDevice for cleanup
+	/// @brief Custom deleter for GPU resources that requires SDL_GPUDevice for cleanup.
+	/// When a GpuReleaseQueue exists for the device, the release is deferred until the current frame has finished.
 	/// @tparam Resource The GPU resource type
 	/// @tparam ReleaseFunc The SDL release function
 	template <typename Resource, auto ReleaseFunc>
@@ -25,16 +29,52 @@ namespace sdl {
 			: gpuDevice_{gpuDevice} {
 		}
 
+		/// @brief Counts a created resource in getGpuMemoryStats(), until the resource is released, i.e. after
+		/// the frame fence when the release is deferred by GpuReleaseQueue.
+		[[nodiscard]]
+		static GpuResourceDeleter tracked(SDL_GPUDevice* gpuDevice, Uint64 bytes, SDL_GPUTextureFormat format = SDL_GPU_TEXTUREFORMAT_INVALID) noexcept {
+			gpu_memory::trackCreate(gpuResourceType<Resource>(), bytes, format);
+			GpuResourceDeleter deleter{gpuDevice};
+			deleter.bytes_ = bytes;
+			deleter.format_ = format;
+			deleter.tracked_ = true;
+			return deleter;
+		}
+
 		void operator()(Resource* resource) const noexcept {
-			if (resource && gpuDevice_) {
-				ReleaseFunc(gpuDevice_, resource);
-			} else if (resource && !gpuDevice_) {
+			if (!resource) {
+				return;
+			}
+			std::optional<gpu_memory::TrackedResource> trackedResource;
+			if (tracked_) {
+				trackedResource = gpu_memory::TrackedResource{gpuResourceType<Resource>(), bytes_, format_};
+			}
+			if (gpuDevice_) {
+				if constexpr (std::same_as<Resource, SDL_GPUFence>) {
+					// Fences are what the release queue waits on, release them directly.
+					ReleaseFunc(gpuDevice_, resource);
+					if (trackedResource) {
+						gpu_memory::trackRelease(*trackedResource);
+					}
+				} else {
+					GpuReleaseQueue::release(gpuDevice_, resource, [](SDL_GPUDevice* gpuDevice, void* pointer) {
+						ReleaseFunc(gpuDevice, static_cast<Resource*>(pointer));
+					}, trackedResource);
+				}
+			} else {
 				spdlog::warn("[GpuResource] Resource destroyed without an associated GpuDevice! Potential leak!");
+				// Can never be released, so it is not counted as live forever.
+				if (trackedResource) {
+					gpu_memory::trackRelease(*trackedResource);
+				}
 			}
 		}
 
 	private:
 		SDL_GPUDevice* gpuDevice_ = nullptr;
+		Uint64 bytes_ = 0;
+		SDL_GPUTextureFormat format_ = SDL_GPU_TEXTUREFORMAT_INVALID;
+		bool tracked_ = false;
 	};
 
 	// Type aliases for GPU resources using unique_ptr with custom deleters
@@ -45,6 +85,7 @@ namespace sdl {
 	using GpuGraphicsPipeline = std::unique_ptr<SDL_GPUGraphicsPipeline, GpuResourceDeleter<SDL_GPUGraphicsPipeline, SDL_ReleaseGPUGraphicsPipeline>>;
 	using GpuComputePipeline = std::unique_ptr<SDL_GPUComputePipeline, GpuResourceDeleter<SDL_GPUComputePipeline, SDL_ReleaseGPUComputePipeline>>;
 	using GpuTransferBuffer = std::unique_ptr<SDL_GPUTransferBuffer, GpuResourceDeleter<SDL_GPUTransferBuffer, SDL_ReleaseGPUTransferBuffer>>;
+	using GpuFence = std::unique_ptr<SDL_GPUFence, GpuResourceDeleter<SDL_GPUFence, SDL_ReleaseGPUFence>>;
 
 	/// @brief Creates a GPU resource wrapped in unique_ptr with proper cleanup
 	/// @tparam Resource The GPU resource type
@@ -65,7 +106,7 @@ namespace sdl {
 			throw sdl::SdlException{"Failed to create GPU resource"};
 		}
 
-		return ResourceUniquePtr{resource, DeleterType{gpuDevice}};
+		return ResourceUniquePtr{resource, DeleterType::tracked(gpuDevice, gpu_memory::resourceBytes(arg), gpu_memory::textureFormat(arg))};
 	}
 
 	inline GpuSampler createGpuSampler(SDL_GPUDevice* gpuDevice, const SDL_GPUSamplerCreateInfo& createInfo) {
@@ -96,6 +137,18 @@ namespace sdl {
 		return createGpuResource<SDL_GPUTransferBuffer, SDL_ReleaseGPUTransferBuffer>(gpuDevice, SDL_CreateGPUTransferBuffer, &createInfo);
 	}
 
+	/// @brief Submits the command buffer and returns the fence signaled when the GPU has finished it
+	/// @param gpuDevice The GPU device used for cleanup of the fence
+	/// @param commandBuffer The command buffer to submit
+	/// @return unique_ptr managing the fence
+	inline GpuFence submitGpuCommandBufferAndAcquireFence(SDL_GPUDevice* gpuDevice, SDL_GPUCommandBuffer* commandBuffer) {
+		SDL_GPUFence* fence = SDL_SubmitGPUCommandBufferAndAcquireFence(commandBuffer);
+		if (!fence) {
+			throw sdl::SdlException{"Failed to submit command buffer"};
+		}
+		return GpuFence{fence, GpuResourceDeleter<SDL_GPUFence, SDL_ReleaseGPUFence>::tracked(gpuDevice, 0)};
+	}
+
 	/// @brief Concept to validate vertex types for GPU usage
 	template<typename T>
 	concept VertexType = 
@@ -103,6 +156,27 @@ namespace sdl {
 		std::is_trivially_copyable_v<T> &&
 		std::is_class_v<T>;
 		
+	/// @brief Concept to validate index types supported by SDL_gpu
+	template<typename T>
+	concept IndexType =
+		std::same_as<T, Uint16> ||
+		std::same_as<T, Uint32>;
+
+	template <IndexType Index>
+	constexpr SDL_GPUIndexElementSize gpuIndexElementSize() noexcept {
+		if constexpr (std::same_as<Index, Uint16>) {
+			return SDL_GPU_INDEXELEMENTSIZE_16BIT;
+		} else {
+			return SDL_GPU_INDEXELEMENTSIZE_32BIT;
+		}
+	}
+
+	/// @brief Binds an index buffer holding indices of type Index
+	template <IndexType Index>
+	void bindGpuIndexBuffer(SDL_GPURenderPass* renderPass, const SDL_GPUBufferBinding& binding) {
+		SDL_BindGPUIndexBuffer(renderPass, &binding, gpuIndexElementSize<Index>());
+	}
+
 	void gpuCopyPass(SDL_GPUCommandBuffer* commandBuffer, std::invocable<SDL_GPUCopyPass*> auto&& t) {
 		SDL_GPUCopyPass* copyPass = SDL_BeginGPUCopyPass(commandBuffer);
 		t(copyPass);
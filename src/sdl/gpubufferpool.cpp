@@ -0,0 +1,113 @@
+#include "gpubufferpool.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace sdl {
+
+	RangeAllocator::RangeAllocator(Uint32 size)
+		: size_{size} {
+
+		if (size > 0) {
+			free_.push_back(Range{0, size});
+		}
+	}
+
+	std::optional<Uint32> RangeAllocator::allocate(Uint32 size, Uint32 alignment) {
+		if (size == 0 || alignment == 0) {
+			throw std::invalid_argument{"[RangeAllocator] Size and alignment must be larger than zero"};
+		}
+		for (auto it = free_.begin(); it != free_.end(); ++it) {
+			const Uint32 offset = (it->offset + alignment - 1) / alignment * alignment;
+			const Uint32 padding = offset - it->offset;
+			if (padding > it->size || it->size - padding < size) {
+				continue;
+			}
+			const Range after{offset + size, it->size - padding - size};
+			if (padding > 0) {
+				// Keep the padding before the range free.
+				it->size = padding;
+				if (after.size > 0) {
+					free_.insert(it + 1, after);
+				}
+			} else if (after.size > 0) {
+				*it = after;
+			} else {
+				free_.erase(it);
+			}
+			used_ += size;
+			return offset;
+		}
+		return std::nullopt;
+	}
+
+	void RangeAllocator::free(Uint32 offset, Uint32 size) {
+		auto it = std::lower_bound(free_.begin(), free_.end(), offset, [](const Range& range, Uint32 value) {
+			return range.offset < value;
+		});
+		it = free_.insert(it, Range{offset, size});
+		used_ -= size;
+
+		if (it + 1 != free_.end() && it->offset + it->size == (it + 1)->offset) {
+			it->size += (it + 1)->size;
+			free_.erase(it + 1);
+		}
+		if (it != free_.begin() && (it - 1)->offset + (it - 1)->size == it->offset) {
+			(it - 1)->size += it->size;
+			free_.erase(it);
+		}
+	}
+
+	GpuBufferPool::GpuBufferPool(SDL_GPUDevice* gpuDevice, SDL_GPUBufferUsageFlags usage, Uint32 blockSize)
+		: gpuDevice_{gpuDevice}
+		, usage_{usage}
+		, blockSize_{blockSize} {
+	}
+
+	GpuBufferPool::Range GpuBufferPool::allocate(Uint32 size, Uint32 alignment) {
+		for (size_t i = 0; i < blocks_.size(); ++i) {
+			if (auto offset = blocks_[i].allocator.allocate(size, alignment)) {
+				return Range{
+					.buffer = blocks_[i].buffer.get(),
+					.offset = *offset,
+					.size = size,
+					.block = static_cast<Uint32>(i)
+				};
+			}
+		}
+
+		const Uint32 blockSize = std::max(blockSize_, size);
+		blocks_.push_back(Block{
+			.buffer = createGpuBuffer(gpuDevice_, SDL_GPUBufferCreateInfo{
+				.usage = usage_,
+				.size = blockSize
+			}),
+			.allocator = RangeAllocator{blockSize}
+		});
+		++stats_.reallocations;
+		stats_.bytesAllocated += blockSize;
+
+		auto& block = blocks_.back();
+		return Range{
+			.buffer = block.buffer.get(),
+			.offset = *block.allocator.allocate(size, alignment),
+			.size = size,
+			.block = static_cast<Uint32>(blocks_.size() - 1)
+		};
+	}
+
+	void GpuBufferPool::free(const Range& range) {
+		if (range.buffer) {
+			blocks_.at(range.block).allocator.free(range.offset, range.size);
+		}
+	}
+
+	size_t GpuBufferPool::getUsedBytes() const noexcept {
+		size_t used = 0;
+		for (const auto& block : blocks_) {
+			used += block.allocator.getUsed();
+		}
+		return used;
+	}
+
+}
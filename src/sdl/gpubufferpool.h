@@ -0,0 +1,107 @@
+#ifndef CPPSDL3_SDL_GPUBUFFERPOOL_H
+#define CPPSDL3_SDL_GPUBUFFERPOOL_H
+
+#include "gpu.h"
+#include "gpuutil.h"
+
+#include <SDL3/SDL_gpu.h>
+
+#include <optional>
+#include <vector>
+
+namespace sdl {
+
+	/// @brief Keeps track of free ranges in [0, size). First fit, freed ranges are merged with their neighbors.
+	/// Only bookkeeping, the memory itself is owned by the user.
+	class RangeAllocator {
+	public:
+		explicit RangeAllocator(Uint32 size = 0);
+
+		/// @return The aligned offset of the range, or nullopt if no free range is large enough
+		[[nodiscard]]
+		std::optional<Uint32> allocate(Uint32 size, Uint32 alignment = 1);
+
+		/// @brief Frees a range returned by allocate(), size must be the allocated size.
+		void free(Uint32 offset, Uint32 size);
+
+		Uint32 getSize() const noexcept {
+			return size_;
+		}
+
+		Uint32 getUsed() const noexcept {
+			return used_;
+		}
+
+		size_t getFreeRangeCount() const noexcept {
+			return free_.size();
+		}
+
+	private:
+		struct Range {
+			Uint32 offset = 0;
+			Uint32 size = 0;
+		};
+
+		std::vector<Range> free_;	// Sorted by offset, never adjacent
+		Uint32 size_ = 0;
+		Uint32 used_ = 0;
+	};
+
+	/// @brief Hands out aligned ranges from a few large GPU buffers instead of one buffer per use.
+	/// A range must only be freed when the GPU no longer uses it.
+	class GpuBufferPool {
+	public:
+		static constexpr Uint32 DefaultBlockSize = 4 * 1024 * 1024;
+
+		struct Range {
+			SDL_GPUBuffer* buffer = nullptr;
+			Uint32 offset = 0;
+			Uint32 size = 0;
+			Uint32 block = 0;
+
+			SDL_GPUBufferBinding getBinding() const noexcept {
+				return {.buffer = buffer, .offset = offset};
+			}
+
+			SDL_GPUBufferRegion getRegion() const noexcept {
+				return {.buffer = buffer, .offset = offset, .size = size};
+			}
+		};
+
+		GpuBufferPool(SDL_GPUDevice* gpuDevice, SDL_GPUBufferUsageFlags usage, Uint32 blockSize = DefaultBlockSize);
+
+		/// @brief Returns a range from an existing block, or from a new block if none has room.
+		/// Sizes larger than the block size get a block of their own.
+		[[nodiscard]]
+		Range allocate(Uint32 size, Uint32 alignment = 16);
+
+		void free(const Range& range);
+
+		size_t getBlockCount() const noexcept {
+			return blocks_.size();
+		}
+
+		/// @brief Reallocations counts the created blocks.
+		const BufferStats& getStats() const noexcept {
+			return stats_;
+		}
+
+		[[nodiscard]]
+		size_t getUsedBytes() const noexcept;
+
+	private:
+		struct Block {
+			GpuBuffer buffer;
+			RangeAllocator allocator;
+		};
+
+		SDL_GPUDevice* gpuDevice_ = nullptr;
+		SDL_GPUBufferUsageFlags usage_ = 0;
+		Uint32 blockSize_ = 0;
+		std::vector<Block> blocks_;
+		BufferStats stats_;
+	};
+
+}
+
+#endif
@@ -0,0 +1,113 @@
+#include "gpumemory.h"
+
+#include <algorithm>
+#include <mutex>
+
+namespace sdl {
+
+	namespace {
+
+		// Covers all texture formats of SDL 3, later formats are only counted in the totals.
+		constexpr size_t MaxTextureFormats = 256;
+
+		struct Tracker {
+			std::mutex mutex;
+			std::array<GpuResourceStats, static_cast<size_t>(GpuResourceType::Count)> resources{};
+			std::array<GpuTextureFormatStats, MaxTextureFormats> textureFormats{};
+		};
+
+		Tracker& tracker() {
+			static Tracker tracker;
+			return tracker;
+		}
+
+	}
+
+	const char* gpuResourceTypeName(GpuResourceType type) noexcept {
+		switch (type) {
+			case GpuResourceType::Texture: return "Texture";
+			case GpuResourceType::Buffer: return "Buffer";
+			case GpuResourceType::TransferBuffer: return "Transfer buffer";
+			case GpuResourceType::Sampler: return "Sampler";
+			case GpuResourceType::Shader: return "Shader";
+			case GpuResourceType::GraphicsPipeline: return "Graphics pipeline";
+			case GpuResourceType::ComputePipeline: return "Compute pipeline";
+			case GpuResourceType::Fence: return "Fence";
+			default: return "Unknown";
+		}
+	}
+
+	Uint64 GpuMemoryStats::getLiveBytes() const noexcept {
+		Uint64 bytes = 0;
+		for (const auto& resource : resources) {
+			bytes += resource.liveBytes;
+		}
+		return bytes;
+	}
+
+	GpuMemoryStats getGpuMemoryStats() {
+		auto& [mutex, resources, textureFormats] = tracker();
+		GpuMemoryStats snapshot;
+		{
+			std::lock_guard lock{mutex};
+			snapshot.resources = resources;
+			for (size_t i = 0; i < textureFormats.size(); ++i) {
+				if (textureFormats[i].liveCount > 0) {
+					snapshot.textureFormats.push_back(textureFormats[i]);
+					snapshot.textureFormats.back().format = static_cast<SDL_GPUTextureFormat>(i);
+				}
+			}
+		}
+		std::ranges::sort(snapshot.textureFormats, std::greater{}, &GpuTextureFormatStats::liveBytes);
+		return snapshot;
+	}
+
+	namespace gpu_memory {
+
+		Uint64 resourceBytes(const SDL_GPUTextureCreateInfo* createInfo) noexcept {
+			const bool is3d = createInfo->type == SDL_GPU_TEXTURETYPE_3D;
+			Uint64 bytes = 0;
+			for (Uint32 level = 0; level < std::max(createInfo->num_levels, 1u); ++level) {
+				bytes += SDL_CalculateGPUTextureFormatSize(createInfo->format,
+					std::max(createInfo->width >> level, 1u),
+					std::max(createInfo->height >> level, 1u),
+					is3d ? std::max(createInfo->layer_count_or_depth >> level, 1u) : 1u);
+			}
+			if (!is3d) {
+				bytes *= std::max(createInfo->layer_count_or_depth, 1u);
+			}
+			// The enum value is log2 of the sample count.
+			return bytes << static_cast<Uint32>(createInfo->sample_count);
+		}
+
+		void trackCreate(GpuResourceType type, Uint64 bytes, SDL_GPUTextureFormat format) noexcept {
+			auto& [mutex, resources, textureFormats] = tracker();
+			std::lock_guard lock{mutex};
+			auto& resource = resources[static_cast<size_t>(type)];
+			++resource.liveCount;
+			++resource.createdCount;
+			resource.liveBytes += bytes;
+			resource.peakBytes = std::max(resource.peakBytes, resource.liveBytes);
+
+			if (type == GpuResourceType::Texture && static_cast<size_t>(format) < MaxTextureFormats) {
+				++textureFormats[format].liveCount;
+				textureFormats[format].liveBytes += bytes;
+			}
+		}
+
+		void trackRelease(GpuResourceType type, Uint64 bytes, SDL_GPUTextureFormat format) noexcept {
+			auto& [mutex, resources, textureFormats] = tracker();
+			std::lock_guard lock{mutex};
+			auto& resource = resources[static_cast<size_t>(type)];
+			--resource.liveCount;
+			resource.liveBytes -= bytes;
+
+			if (type == GpuResourceType::Texture && static_cast<size_t>(format) < MaxTextureFormats) {
+				--textureFormats[format].liveCount;
+				textureFormats[format].liveBytes -= bytes;
+			}
+		}
+
+	}
+
+}
@@ -0,0 +1,133 @@
+#ifndef CPPSDL3_SDL_GPUMEMORY_H
+#define CPPSDL3_SDL_GPUMEMORY_H
+
+#include <SDL3/SDL_gpu.h>
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <vector>
+
+namespace sdl {
+
+	enum class GpuResourceType {
+		Texture,
+		Buffer,
+		TransferBuffer,
+		Sampler,
+		Shader,
+		GraphicsPipeline,
+		ComputePipeline,
+		Fence,
+		Count
+	};
+
+	[[nodiscard]]
+	const char* gpuResourceTypeName(GpuResourceType type) noexcept;
+
+	template <typename Resource>
+	constexpr GpuResourceType gpuResourceType() noexcept {
+		if constexpr (std::same_as<Resource, SDL_GPUTexture>) {
+			return GpuResourceType::Texture;
+		} else if constexpr (std::same_as<Resource, SDL_GPUBuffer>) {
+			return GpuResourceType::Buffer;
+		} else if constexpr (std::same_as<Resource, SDL_GPUTransferBuffer>) {
+			return GpuResourceType::TransferBuffer;
+		} else if constexpr (std::same_as<Resource, SDL_GPUSampler>) {
+			return GpuResourceType::Sampler;
+		} else if constexpr (std::same_as<Resource, SDL_GPUShader>) {
+			return GpuResourceType::Shader;
+		} else if constexpr (std::same_as<Resource, SDL_GPUGraphicsPipeline>) {
+			return GpuResourceType::GraphicsPipeline;
+		} else if constexpr (std::same_as<Resource, SDL_GPUComputePipeline>) {
+			return GpuResourceType::ComputePipeline;
+		} else {
+			static_assert(std::same_as<Resource, SDL_GPUFence>, "Unknown GPU resource type");
+			return GpuResourceType::Fence;
+		}
+	}
+
+	struct GpuResourceStats {
+		size_t liveCount = 0;
+		Uint64 liveBytes = 0;
+		Uint64 peakBytes = 0;
+		size_t createdCount = 0;
+	};
+
+	struct GpuTextureFormatStats {
+		SDL_GPUTextureFormat format = SDL_GPU_TEXTUREFORMAT_INVALID;
+		size_t liveCount = 0;
+		Uint64 liveBytes = 0;
+	};
+
+	/// @brief Snapshot of the resources created through createGpuResource and not yet released.
+	/// Bytes are estimated from the create info, i.e. without driver alignment and metadata.
+	struct GpuMemoryStats {
+		std::array<GpuResourceStats, static_cast<size_t>(GpuResourceType::Count)> resources{};
+		std::vector<GpuTextureFormatStats> textureFormats;	///< Live textures per format, largest first
+
+		[[nodiscard]]
+		const GpuResourceStats& operator[](GpuResourceType type) const noexcept {
+			return resources[static_cast<size_t>(type)];
+		}
+
+		[[nodiscard]]
+		Uint64 getLiveBytes() const noexcept;
+	};
+
+	/// @brief Returns the current totals, for all devices. Is thread safe.
+	[[nodiscard]]
+	GpuMemoryStats getGpuMemoryStats();
+
+	namespace gpu_memory {
+
+		/// @brief Estimated size of the texture including all mip levels, layers and samples.
+		[[nodiscard]]
+		Uint64 resourceBytes(const SDL_GPUTextureCreateInfo* createInfo) noexcept;
+
+		[[nodiscard]]
+		inline Uint64 resourceBytes(const SDL_GPUBufferCreateInfo* createInfo) noexcept {
+			return createInfo->size;
+		}
+
+		[[nodiscard]]
+		inline Uint64 resourceBytes(const SDL_GPUTransferBufferCreateInfo* createInfo) noexcept {
+			return createInfo->size;
+		}
+
+		// Resources without a meaningful size, e.g. samplers and pipelines.
+		[[nodiscard]]
+		inline Uint64 resourceBytes(const void*) noexcept {
+			return 0;
+		}
+
+		[[nodiscard]]
+		inline SDL_GPUTextureFormat textureFormat(const SDL_GPUTextureCreateInfo* createInfo) noexcept {
+			return createInfo->format;
+		}
+
+		[[nodiscard]]
+		inline SDL_GPUTextureFormat textureFormat(const void*) noexcept {
+			return SDL_GPU_TEXTUREFORMAT_INVALID;
+		}
+
+		/// @brief What trackCreate counted for a resource, handed to trackRelease when it is really released.
+		struct TrackedResource {
+			GpuResourceType type = GpuResourceType::Texture;
+			Uint64 bytes = 0;
+			SDL_GPUTextureFormat format = SDL_GPU_TEXTUREFORMAT_INVALID;
+		};
+
+		void trackCreate(GpuResourceType type, Uint64 bytes, SDL_GPUTextureFormat format) noexcept;
+
+		void trackRelease(GpuResourceType type, Uint64 bytes, SDL_GPUTextureFormat format) noexcept;
+
+		inline void trackRelease(const TrackedResource& resource) noexcept {
+			trackRelease(resource.type, resource.bytes, resource.format);
+		}
+
+	}
+
+}
+
+#endif
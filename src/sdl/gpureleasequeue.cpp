@@ -0,0 +1,135 @@
+#include "gpureleasequeue.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace sdl {
+
+	namespace {
+
+		struct Registry {
+			std::mutex mutex;
+			std::vector<std::pair<SDL_GPUDevice*, GpuReleaseQueue*>> queues;
+		};
+
+		Registry& registry() {
+			static Registry registry;
+			return registry;
+		}
+
+	}
+
+	GpuReleaseQueue::GpuReleaseQueue(SDL_GPUDevice* gpuDevice)
+		: gpuDevice_{gpuDevice} {
+
+		auto& [mutex, queues] = registry();
+		std::lock_guard lock{mutex};
+		auto it = std::find_if(queues.begin(), queues.end(), [gpuDevice](const auto& entry) { return entry.first == gpuDevice; });
+		if (it != queues.end()) {
+			spdlog::warn("[GpuReleaseQueue] Replacing the release queue already registered for the device");
+			it->second = this;
+		} else {
+			queues.emplace_back(gpuDevice, this);
+		}
+	}
+
+	GpuReleaseQueue::~GpuReleaseQueue() {
+		{
+			auto& [mutex, queues] = registry();
+			std::lock_guard lock{mutex};
+			std::erase_if(queues, [this](const auto& entry) { return entry.second == this; });
+		}
+
+		std::lock_guard lock{mutex_};
+		for (auto& frame : frames_) {
+			if (frame.fence) {
+				SDL_WaitForGPUFences(gpuDevice_, true, &frame.fence, 1);
+			}
+			releaseFrame(frame);
+		}
+		frames_.clear();
+		for (const auto& resource : current_) {
+			releaseNow(gpuDevice_, resource);
+		}
+		current_.clear();
+	}
+
+	void GpuReleaseQueue::release(SDL_GPUDevice* gpuDevice, void* resource, ReleaseFunction releaseFunction,
+		const std::optional<gpu_memory::TrackedResource>& tracked) noexcept {
+
+		const Resource pending{releaseFunction, resource, tracked};
+		{
+			auto& [mutex, queues] = registry();
+			std::lock_guard lock{mutex};
+			auto it = std::find_if(queues.begin(), queues.end(), [gpuDevice](const auto& entry) { return entry.first == gpuDevice; });
+			if (it != queues.end()) {
+				it->second->enqueue(pending);
+				return;
+			}
+		}
+		releaseNow(gpuDevice, pending);
+	}
+
+	void GpuReleaseQueue::endFrame(SDL_GPUFence* fence) {
+		std::lock_guard lock{mutex_};
+		if (!fence) {
+			return;
+		}
+		frames_.push_back(Frame{
+			.fence = fence,
+			.resources = std::exchange(current_, {})
+		});
+	}
+
+	size_t GpuReleaseQueue::collect() {
+		std::deque<Frame> finished;
+		{
+			std::lock_guard lock{mutex_};
+			// Frames finish in submission order.
+			while (!frames_.empty() && SDL_QueryGPUFence(gpuDevice_, frames_.front().fence)) {
+				finished.push_back(std::move(frames_.front()));
+				frames_.pop_front();
+			}
+		}
+		// Released outside the lock, so other threads dropping resources are not blocked.
+		for (auto& frame : finished) {
+			releaseFrame(frame);
+		}
+		return finished.size();
+	}
+
+	size_t GpuReleaseQueue::getPendingCount() const {
+		std::lock_guard lock{mutex_};
+		size_t count = current_.size();
+		for (const auto& frame : frames_) {
+			count += frame.resources.size();
+		}
+		return count;
+	}
+
+	void GpuReleaseQueue::releaseNow(SDL_GPUDevice* gpuDevice, const Resource& resource) noexcept {
+		resource.release(gpuDevice, resource.resource);
+		if (resource.tracked) {
+			gpu_memory::trackRelease(*resource.tracked);
+		}
+	}
+
+	void GpuReleaseQueue::enqueue(const Resource& resource) {
+		std::lock_guard lock{mutex_};
+		current_.push_back(resource);
+	}
+
+	void GpuReleaseQueue::releaseFrame(Frame& frame) {
+		for (const auto& resource : frame.resources) {
+			releaseNow(gpuDevice_, resource);
+		}
+		frame.resources.clear();
+		if (frame.fence) {
+			SDL_ReleaseGPUFence(gpuDevice_, frame.fence);
+			frame.fence = nullptr;
+		}
+	}
+
+}
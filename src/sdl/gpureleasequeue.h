@@ -0,0 +1,77 @@
+#ifndef CPPSDL3_SDL_GPURELEASEQUEUE_H
+#define CPPSDL3_SDL_GPURELEASEQUEUE_H
+
+#include "gpumemory.h"
+
+#include <SDL3/SDL_gpu.h>
+
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace sdl {
+
+	/// @brief Defers the release of GPU resources until the GPU has finished the frame they were dropped in.
+	/// While a queue exists for a device, GpuResourceDeleter hands the resources of that device to the queue
+	/// instead of releasing them directly. Resources dropped before endFrame() are released once the fence
+	/// passed to it has signaled. sdl::Window owns one queue for its device. Tracked resources stay in
+	/// getGpuMemoryStats() until they are released here, since the GPU memory is only freed then.
+	class GpuReleaseQueue {
+	public:
+		using ReleaseFunction = void (*)(SDL_GPUDevice*, void*);
+
+		/// @brief Registers the queue as the release queue of the device, at most one queue per device.
+		explicit GpuReleaseQueue(SDL_GPUDevice* gpuDevice);
+
+		/// @brief Unregisters the queue, waits for the pending frames and releases all resources.
+		~GpuReleaseQueue();
+
+		GpuReleaseQueue(const GpuReleaseQueue&) = delete;
+		GpuReleaseQueue& operator=(const GpuReleaseQueue&) = delete;
+
+		/// @brief Releases the resource through the queue registered for the device, or directly if there is none.
+		/// Is thread safe.
+		/// @param tracked Passed to gpu_memory::trackRelease when the resource is released
+		static void release(SDL_GPUDevice* gpuDevice, void* resource, ReleaseFunction releaseFunction,
+			const std::optional<gpu_memory::TrackedResource>& tracked = std::nullopt) noexcept;
+
+		/// @brief Ties the resources dropped since the last call to the fence and takes ownership of it.
+		/// With a null fence, e.g. a failed submit, the resources are kept for the next frame.
+		void endFrame(SDL_GPUFence* fence);
+
+		/// @brief Releases the resources of all frames whose fence has signaled. Never waits.
+		/// @return Number of frames found finished, frames finish in the order endFrame() was called
+		size_t collect();
+
+		/// @brief Number of resources waiting to be released.
+		[[nodiscard]]
+		size_t getPendingCount() const;
+
+	private:
+		struct Resource {
+			ReleaseFunction release = nullptr;
+			void* resource = nullptr;
+			std::optional<gpu_memory::TrackedResource> tracked;
+		};
+
+		struct Frame {
+			SDL_GPUFence* fence = nullptr;
+			std::vector<Resource> resources;
+		};
+
+		static void releaseNow(SDL_GPUDevice* gpuDevice, const Resource& resource) noexcept;
+
+		void enqueue(const Resource& resource);
+
+		void releaseFrame(Frame& frame);
+
+		SDL_GPUDevice* gpuDevice_ = nullptr;
+		mutable std::mutex mutex_;
+		std::vector<Resource> current_;
+		std::deque<Frame> frames_;
+	};
+
+}
+
+#endif
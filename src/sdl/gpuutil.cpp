@@ -1,4 +1,5 @@
 #include "gpuutil.h"
+#include "mipmap.h"
 #include "gpu.h"
 #include "util.h"
 #include "sdlexception.h"
@@ -6,136 +7,432 @@
 #include "imageatlas.h"
 
 #include <stdexcept>
+#include <algorithm>
+#include <bit>
+#include <cstring>
 
 namespace sdl {
 
-	GpuTexture uploadSurface(SDL_GPUDevice* gpuDevice, SDL_Surface* surface) {
-		SdlSurface convertedSurfacePtr;
-		if (surface->format != SDL_PIXELFORMAT_RGBA32) {
-			convertedSurfacePtr.reset(SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGBA32));
+	namespace {
+
+		// Texture data placement alignment required by Direct3D 12, SDL copies unaligned data otherwise.
+		constexpr Uint32 TextureAlignment = 512;
+		constexpr Uint32 BufferAlignment = 16;
+
+		constexpr Uint32 alignUp(Uint32 value, Uint32 alignment) noexcept {
+			return (value + alignment - 1) / alignment * alignment;
 		}
-		surface = convertedSurfacePtr ? convertedSurfacePtr.get() : surface;
 
-		GpuTransferBuffer transferBuffer = createGpuTransferBuffer(
-			gpuDevice,
-			SDL_GPUTransferBufferCreateInfo{
-				.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-				.size = static_cast<Uint32>(surface->w * surface->h * 4)
+		SDL_Surface* toRgba32(SDL_Surface* surface, SdlSurface& converted) {
+			if (surface->format == SDL_PIXELFORMAT_RGBA32) {
+				return surface;
+			}
+			converted.reset(SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGBA32));
+			if (!converted) {
+				throw sdl::SdlException{"Failed to convert surface to RGBA32"};
 			}
-		);
+			return converted.get();
+		}
 
-		mapGpuTransferBuffer(
-			gpuDevice,
-			transferBuffer.get(),
-			std::span{(Uint8*)surface->pixels, static_cast<size_t>(surface->w * surface->h * 4)},
-			false
-		);
+	}
 
-		SDL_GPUTextureCreateInfo textureInfo{
-			.type = SDL_GPU_TEXTURETYPE_2D,
-			.format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
-			.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER,
-			.width = static_cast<Uint32>(surface->w),
-			.height = static_cast<Uint32>(surface->h),
-			.layer_count_or_depth = 1,
-			.num_levels = 1,
+	size_t computeCapacity(size_t capacity, size_t required, const BufferGrowth& growth) noexcept {
+		if (required <= capacity) {
+			return capacity;
+		}
+		size_t size = required;
+		switch (growth.policy) {
+			case GrowthPolicy::Exact:
+				break;
+			case GrowthPolicy::PowerOfTwo:
+				size = std::bit_ceil(required);
+				break;
+			case GrowthPolicy::OneAndHalf:
+				size = std::max(required, capacity + capacity / 2);
+				break;
+		}
+		size = std::max(size, growth.minSize);
+		if (growth.maxSize != 0) {
+			size = std::min(size, std::max(growth.maxSize, required));
+		}
+		return size;
+	}
+
+	SDL_GPUSamplerCreateInfo samplerCreateInfo(SamplerPreset preset) noexcept {
+		const bool nearest = preset == SamplerPreset::NearestClamp || preset == SamplerPreset::NearestRepeat;
+		const bool trilinear = preset == SamplerPreset::TrilinearClamp || preset == SamplerPreset::TrilinearRepeat;
+		const bool repeat = preset == SamplerPreset::NearestRepeat || preset == SamplerPreset::LinearRepeat || preset == SamplerPreset::TrilinearRepeat;
+
+		const auto filter = nearest ? SDL_GPU_FILTER_NEAREST : SDL_GPU_FILTER_LINEAR;
+		const auto addressMode = repeat ? SDL_GPU_SAMPLERADDRESSMODE_REPEAT : SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE;
+		return SDL_GPUSamplerCreateInfo{
+			.min_filter = filter,
+			.mag_filter = filter,
+			.mipmap_mode = trilinear ? SDL_GPU_SAMPLERMIPMAPMODE_LINEAR : SDL_GPU_SAMPLERMIPMAPMODE_NEAREST,
+			.address_mode_u = addressMode,
+			.address_mode_v = addressMode,
+			.address_mode_w = addressMode,
+			// Only the trilinear presets sample below the base level.
+			.max_lod = trilinear ? 1000.f : 0.f
 		};
-		auto texture = createGpuTexture(gpuDevice, textureInfo);
+	}
 
-		SDL_GPUCommandBuffer* uploadCmdBuf = SDL_AcquireGPUCommandBuffer(gpuDevice);
-		if (!uploadCmdBuf) {
-			throw sdl::SdlException("Failed to acquire command buffer");
+	GpuTexture uploadSurface(SDL_GPUDevice* gpuDevice, SDL_Surface* surface, MipMode mipMode) {
+		UploadQueue uploadQueue{gpuDevice, 0};
+		auto texture = uploadQueue.uploadSurface(surface, mipMode);
+		uploadQueue.submit();
+		return texture;
+	}
+
+	SDL_Rect blitToGpuTexture(SDL_GPUDevice* gpuDevice, SDL_GPUTexture* texture, sdl::ImageAtlas& imageAtlas, SDL_Surface* surface, int border) {
+		UploadQueue uploadQueue{gpuDevice, 0};
+		auto rect = uploadQueue.blitSurface(surface, texture, imageAtlas, border);
+		uploadQueue.submit();
+		return rect;
+	}
+
+	UploadPlacement placeUpload(Uint32 used, Uint32 capacity, Uint32 size, Uint32 alignment, Uint32 chunkSize) noexcept {
+		const Uint32 offset = alignUp(used, alignment);
+		if (offset + size <= capacity) {
+			return {.offset = offset};
 		}
+		return {.offset = 0, .newChunkSize = std::max(chunkSize, size)};
+	}
 
-		sdl::gpuCopyPass(uploadCmdBuf, [&](SDL_GPUCopyPass* copyPass) {
-			SDL_GPUTextureTransferInfo transferInfo{
-				.transfer_buffer = transferBuffer.get(),
-				.offset = 0,
-			};
+	UploadQueue::UploadQueue(SDL_GPUDevice* gpuDevice, Uint32 chunkSize)
+		: gpuDevice_{gpuDevice}
+		, chunkSize_{chunkSize} {
+	}
 
-			SDL_GPUTextureRegion textureRegion{
-				.texture = texture.get(),
-				.w = static_cast<Uint32>(surface->w),
-				.h = static_cast<Uint32>(surface->h),
-				.d = 1
-			};
+	UploadQueue::~UploadQueue() {
+		unmap();
+	}
 
-			SDL_UploadToGPUTexture(
-				copyPass,
-				&transferInfo,
-				&textureRegion,
-				false
-			);
-		});
+	GpuTexture UploadQueue::uploadSurface(SDL_Surface* surface, MipMode mipMode) {
+		SdlSurface converted;
+		surface = toRgba32(surface, converted);
 
-		if (!SDL_SubmitGPUCommandBuffer(uploadCmdBuf)) {
-			throw sdl::SdlException{"Failed to submit command buffer"};
+		switch (mipMode) {
+			case MipMode::Cpu:
+				return uploadSurface(surface, generateMipChain(surface));
+			case MipMode::Gpu: {
+				auto texture = createTexture(surface, mipLevelCount(surface->w, surface->h), SDL_GPU_TEXTUREUSAGE_SAMPLER | SDL_GPU_TEXTUREUSAGE_COLOR_TARGET);
+				uploadPixels(surface->pixels, surface->pitch, texture.get(), SDL_Rect{0, 0, surface->w, surface->h});
+				mipmapTextures_.push_back(texture.get());
+				return texture;
+			}
+			default: {
+				auto texture = createTexture(surface, 1, SDL_GPU_TEXTUREUSAGE_SAMPLER);
+				uploadPixels(surface->pixels, surface->pitch, texture.get(), SDL_Rect{0, 0, surface->w, surface->h});
+				return texture;
+			}
 		}
+	}
 
+	GpuTexture UploadQueue::uploadSurface(SDL_Surface* surface, std::span<const SdlSurface> mipLevels) {
+		SdlSurface converted;
+		surface = toRgba32(surface, converted);
+
+		auto texture = createTexture(surface, static_cast<Uint32>(mipLevels.size()) + 1, SDL_GPU_TEXTUREUSAGE_SAMPLER);
+		uploadPixels(surface->pixels, surface->pitch, texture.get(), SDL_Rect{0, 0, surface->w, surface->h});
+		for (Uint32 level = 1; level <= mipLevels.size(); ++level) {
+			SDL_Surface* mipLevel = mipLevels[level - 1].get();
+			if (mipLevel->format != SDL_PIXELFORMAT_RGBA32
+				|| static_cast<Uint32>(mipLevel->w) != mipLevelSize(surface->w, level)
+				|| static_cast<Uint32>(mipLevel->h) != mipLevelSize(surface->h, level)) {
+				throw std::invalid_argument{fmt::format("Mip level {} must be RGBA32 of size {}x{}",
+					level, mipLevelSize(surface->w, level), mipLevelSize(surface->h, level))};
+			}
+			uploadPixels(mipLevel->pixels, mipLevel->pitch, texture.get(), SDL_Rect{0, 0, mipLevel->w, mipLevel->h}, level);
+		}
 		return texture;
 	}
 
-	SDL_Rect blitToGpuTexture(SDL_GPUDevice* gpuDevice, SDL_GPUTexture* texture, sdl::ImageAtlas& imageAtlas, SDL_Surface* surface, int border) {
-		SdlSurface convertedSurfacePtr;
-		if (surface->format != SDL_PIXELFORMAT_RGBA32) {
-			convertedSurfacePtr.reset(SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGBA32));
-		}
-		surface = convertedSurfacePtr ? convertedSurfacePtr.get() : surface;
+	SDL_Rect UploadQueue::blitSurface(SDL_Surface* surface, SDL_GPUTexture* texture, ImageAtlas& imageAtlas, int border) {
+		SdlSurface converted;
+		surface = toRgba32(surface, converted);
 
-		auto rectOptional = imageAtlas.add(surface->w, surface->h, border);
-		if (!rectOptional) {
+		auto rect = imageAtlas.add(surface->w, surface->h, border);
+		if (!rect) {
 			throw std::runtime_error{"Failed to blit surface to atlas"};
 		}
-		auto rect = *rectOptional;
+		uploadPixels(surface->pixels, surface->pitch, texture, *rect);
+		return *rect;
+	}
+
+	void UploadQueue::uploadPixels(const void* pixels, int pitch, SDL_GPUTexture* texture, const SDL_Rect& rect, Uint32 mipLevel) {
+		auto destination = mapPixels(texture, rect, mipLevel);
+		if (destination.empty()) {
+			return;
+		}
 
-		GpuTransferBuffer transferBuffer = createGpuTransferBuffer(
-			gpuDevice,
-			SDL_GPUTransferBufferCreateInfo{
-				.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-				.size = static_cast<Uint32>(surface->w * surface->h * 4)
+		const auto rowBytes = static_cast<size_t>(rect.w) * 4;
+		auto source = static_cast<const std::byte*>(pixels);
+		if (static_cast<size_t>(pitch) == rowBytes) {
+			std::memcpy(destination.data(), source, destination.size());
+		} else {
+			for (int row = 0; row < rect.h; ++row) {
+				std::memcpy(destination.data() + row * rowBytes, source + row * pitch, rowBytes);
 			}
-		);
-
-		mapGpuTransferBuffer(
-			gpuDevice,
-			transferBuffer.get(),
-			std::span{(Uint8*)surface->pixels, static_cast<size_t>(surface->w * surface->h * 4)},
-			false
-		);
+		}
+	}
 
-		SDL_GPUCommandBuffer* uploadCmdBuf = SDL_AcquireGPUCommandBuffer(gpuDevice);
-		if (!uploadCmdBuf) {
-			throw sdl::SdlException("Failed to acquire command buffer");
+	std::span<std::byte> UploadQueue::mapPixels(SDL_GPUTexture* texture, const SDL_Rect& rect, Uint32 mipLevel, Uint32 bytesPerPixel) {
+		const auto size = static_cast<Uint32>(rect.w) * static_cast<Uint32>(rect.h) * bytesPerPixel;
+		if (size == 0) {
+			return {};
 		}
 
-		sdl::gpuCopyPass(uploadCmdBuf, [&](SDL_GPUCopyPass* copyPass) {
-			SDL_GPUTextureTransferInfo transferInfo{
-				.transfer_buffer = transferBuffer.get(),
-				.offset = 0,
-			};
+		SDL_GPUTransferBuffer* transferBuffer = nullptr;
+		Uint32 offset = 0;
+		auto destination = allocate(size, TextureAlignment, transferBuffer, offset);
 
-			SDL_GPUTextureRegion textureRegion{
+		textureUploads_.push_back(TextureUpload{
+			.source = SDL_GPUTextureTransferInfo{
+				.transfer_buffer = transferBuffer,
+				.offset = offset,
+				.pixels_per_row = static_cast<Uint32>(rect.w),
+				.rows_per_layer = static_cast<Uint32>(rect.h)
+			},
+			.destination = SDL_GPUTextureRegion{
 				.texture = texture,
+				.mip_level = mipLevel,
 				.x = static_cast<Uint32>(rect.x),
 				.y = static_cast<Uint32>(rect.y),
 				.w = static_cast<Uint32>(rect.w),
 				.h = static_cast<Uint32>(rect.h),
 				.d = 1
-			};
+			}
+		});
+		return {destination, size};
+	}
+
+	void UploadQueue::uploadBytes(std::span<const std::byte> data, SDL_GPUBuffer* buffer, Uint32 offset) {
+		if (data.empty()) {
+			return;
+		}
+		const auto size = static_cast<Uint32>(data.size());
+		SDL_GPUTransferBuffer* transferBuffer = nullptr;
+		Uint32 transferOffset = 0;
+		std::memcpy(allocate(size, BufferAlignment, transferBuffer, transferOffset), data.data(), size);
 
-			SDL_UploadToGPUTexture(
-				copyPass,
-				&transferInfo,
-				&textureRegion,
-				false
-			);
+		bufferUploads_.push_back(BufferUpload{
+			.source = SDL_GPUTransferBufferLocation{
+				.transfer_buffer = transferBuffer,
+				.offset = transferOffset
+			},
+			.destination = SDL_GPUBufferRegion{
+				.buffer = buffer,
+				.offset = offset,
+				.size = size
+			}
 		});
+	}
 
-		if (!SDL_SubmitGPUCommandBuffer(uploadCmdBuf)) {
-			throw sdl::SdlException{"Failed to submit command buffer"};
+	void UploadQueue::record(SDL_GPUCommandBuffer* commandBuffer) {
+		unmap();
+		if (!isEmpty()) {
+			gpuCopyPass(commandBuffer, [&](SDL_GPUCopyPass* copyPass) {
+				for (const auto& upload : textureUploads_) {
+					SDL_UploadToGPUTexture(copyPass, &upload.source, &upload.destination, false);
+				}
+				for (const auto& upload : bufferUploads_) {
+					SDL_UploadToGPUBuffer(copyPass, &upload.source, &upload.destination, false);
+				}
+			});
 		}
+		// Generated from the uploaded base level, so after the copy pass.
+		for (auto texture : mipmapTextures_) {
+			SDL_GenerateMipmapsForGPUTexture(commandBuffer, texture);
+		}
+		textureUploads_.clear();
+		bufferUploads_.clear();
+		mipmapTextures_.clear();
+		queuedBytes_ = 0;
+		// SDL keeps the transfer buffers alive until the command buffer is done.
+		transferBuffers_.clear();
+	}
 
-		return rect;
+	GpuFence UploadQueue::submit() {
+		SDL_GPUCommandBuffer* commandBuffer = SDL_AcquireGPUCommandBuffer(gpuDevice_);
+		if (!commandBuffer) {
+			throw sdl::SdlException{"[UploadQueue] Failed to acquire command buffer"};
+		}
+		record(commandBuffer);
+		return submitGpuCommandBufferAndAcquireFence(gpuDevice_, commandBuffer);
+	}
+
+	GpuTexture UploadQueue::createTexture(SDL_Surface* surface, Uint32 levelCount, SDL_GPUTextureUsageFlags usage) {
+		return createGpuTexture(gpuDevice_, SDL_GPUTextureCreateInfo{
+			.type = SDL_GPU_TEXTURETYPE_2D,
+			.format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
+			.usage = usage,
+			.width = static_cast<Uint32>(surface->w),
+			.height = static_cast<Uint32>(surface->h),
+			.layer_count_or_depth = 1,
+			.num_levels = levelCount,
+		});
+	}
+
+	std::byte* UploadQueue::allocate(Uint32 size, Uint32 alignment, SDL_GPUTransferBuffer*& transferBuffer, Uint32& offset) {
+		// Without a mapped chunk the capacity is 0, so a new chunk is started.
+		const auto placement = placeUpload(used_, capacity_, size, alignment, chunkSize_);
+		if (placement.newChunkSize != 0) {
+			unmap();
+			transferBuffers_.push_back(createGpuTransferBuffer(gpuDevice_, SDL_GPUTransferBufferCreateInfo{
+				.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+				.size = placement.newChunkSize
+			}));
+			mapped_ = static_cast<std::byte*>(SDL_MapGPUTransferBuffer(gpuDevice_, transferBuffers_.back().get(), false));
+			if (!mapped_) {
+				throw sdl::SdlException{"[UploadQueue] Failed to map transfer buffer"};
+			}
+			capacity_ = placement.newChunkSize;
+		}
+		offset = placement.offset;
+		queuedBytes_ += offset + size - used_;
+		used_ = offset + size;
+		transferBuffer = transferBuffers_.back().get();
+		return mapped_ + offset;
+	}
+
+	void UploadQueue::unmap() {
+		if (mapped_) {
+			SDL_UnmapGPUTransferBuffer(gpuDevice_, transferBuffers_.back().get());
+			mapped_ = nullptr;
+		}
+		used_ = 0;
+		capacity_ = 0;
+	}
+
+	StreamingBuffer::StreamingBuffer(SDL_GPUBufferUsageFlags usage, int framesInFlight)
+		: frames_(std::max(framesInFlight, 1))
+		, usage_{usage} {
+	}
+
+	StreamingBuffer::~StreamingBuffer() {
+		if (mapped_) {
+			SDL_UnmapGPUTransferBuffer(gpuDevice_, frames_[current_].transferBuffer.get());
+		}
+	}
+
+	void StreamingBuffer::beginFrame(SDL_GPUDevice* gpuDevice) {
+		if (mapped_) {
+			spdlog::warn("[StreamingBuffer] beginFrame called without endFrame, data is discarded");
+			SDL_UnmapGPUTransferBuffer(gpuDevice_, frames_[current_].transferBuffer.get());
+			mapped_ = nullptr;
+		}
+		gpuDevice_ = gpuDevice;
+		current_ = (current_ + 1) % frames_.size();
+		used_ = 0;
+
+		auto& frame = frames_[current_];
+		if (frame.fence) {
+			SDL_GPUFence* fence = frame.fence.get();
+			if (!SDL_WaitForGPUFences(gpuDevice_, true, &fence, 1)) {
+				throw sdl::SdlException{"[StreamingBuffer] Failed to wait for fence"};
+			}
+			frame.fence.reset();
+		}
+
+		if (capacity_ == 0) {
+			return;
+		}
+		if (frame.transferCapacity < capacity_) {
+			frame.transferBuffer = createGpuTransferBuffer(gpuDevice_, SDL_GPUTransferBufferCreateInfo{
+				.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+				.size = capacity_
+			});
+			frame.transferCapacity = capacity_;
+		}
+		// The fence guarantees that the GPU is done with the slot, no need to cycle.
+		mapped_ = static_cast<std::byte*>(SDL_MapGPUTransferBuffer(gpuDevice_, frame.transferBuffer.get(), false));
+		if (!mapped_) {
+			throw sdl::SdlException{"[StreamingBuffer] Failed to map transfer buffer"};
+		}
+	}
+
+	StreamingBuffer::Allocation StreamingBuffer::pushBytes(const void* data, size_t bytes) {
+		if (!gpuDevice_) {
+			throw std::logic_error{"[StreamingBuffer] push called before beginFrame"};
+		}
+		Uint32 offset = alignUp(used_, Alignment);
+		Uint32 size = static_cast<Uint32>(bytes);
+		if (!mapped_ || offset + size > frames_[current_].transferCapacity) {
+			grow(offset + size);
+		}
+		SDL_memcpy(mapped_ + offset, data, size);
+		used_ = offset + size;
+		return {
+			.offset = offset,
+			.size = size
+		};
+	}
+
+	void StreamingBuffer::grow(Uint32 required) {
+		capacity_ = static_cast<Uint32>(computeCapacity(capacity_, required, BufferGrowth{
+			.policy = GrowthPolicy::PowerOfTwo,
+			.minSize = MinCapacity
+		}));
+
+		auto& frame = frames_[current_];
+		auto transferBuffer = createGpuTransferBuffer(gpuDevice_, SDL_GPUTransferBufferCreateInfo{
+			.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+			.size = capacity_
+		});
+		auto mapped = static_cast<std::byte*>(SDL_MapGPUTransferBuffer(gpuDevice_, transferBuffer.get(), false));
+		if (!mapped) {
+			throw sdl::SdlException{"[StreamingBuffer] Failed to map transfer buffer"};
+		}
+		if (mapped_) {
+			SDL_memcpy(mapped, mapped_, used_);
+			SDL_UnmapGPUTransferBuffer(gpuDevice_, frame.transferBuffer.get());
+		}
+		frame.transferBuffer = std::move(transferBuffer);
+		frame.transferCapacity = capacity_;
+		mapped_ = mapped;
+	}
+
+	void StreamingBuffer::endFrame() {
+		if (!mapped_) {
+			return;
+		}
+		auto& frame = frames_[current_];
+		SDL_UnmapGPUTransferBuffer(gpuDevice_, frame.transferBuffer.get());
+		mapped_ = nullptr;
+
+		if (used_ == 0) {
+			return;
+		}
+		if (frame.bufferCapacity < frame.transferCapacity) {
+			frame.buffer = createGpuBuffer(gpuDevice_, SDL_GPUBufferCreateInfo{
+				.usage = usage_,
+				.size = frame.transferCapacity
+			});
+			frame.bufferCapacity = frame.transferCapacity;
+		}
+
+		SDL_GPUCommandBuffer* uploadCmdBuf = SDL_AcquireGPUCommandBuffer(gpuDevice_);
+		if (!uploadCmdBuf) {
+			throw sdl::SdlException{"[StreamingBuffer] Failed to acquire command buffer"};
+		}
+
+		sdl::gpuCopyPass(uploadCmdBuf, [&](SDL_GPUCopyPass* copyPass) {
+			SDL_GPUTransferBufferLocation location{
+				.transfer_buffer = frame.transferBuffer.get(),
+				.offset = 0
+			};
+
+			SDL_GPUBufferRegion region{
+				.buffer = frame.buffer.get(),
+				.offset = 0,
+				.size = used_
+			};
+
+			SDL_UploadToGPUBuffer(copyPass, &location, &region, false);
+		});
+
+		frame.fence = submitGpuCommandBufferAndAcquireFence(gpuDevice_, uploadCmdBuf);
 	}
 
 }
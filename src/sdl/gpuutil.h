@@ -2,31 +2,212 @@
 #define CPPSDL3_SDL_GPUUTIL_H
 
 #include "gpu.h"
+#include "batch.h"
 #include "imageatlas.h"
+#include "util.h"
 
 #include <SDL3/SDL_surface.h>
 
+#include <cstddef>
+#include <vector>
+
 namespace sdl {
-	
+
+	/// @brief How the mip levels of an uploaded texture are created.
+	enum class MipMode {
+		None,	///< Only the base level
+		Gpu,	///< Full chain generated by SDL_GenerateMipmapsForGPUTexture, the texture is also a color target
+		Cpu		///< Full chain generated by the box filter in generateMipChain and uploaded with the base level
+	};
+
+	/// @brief Canonical sampler configurations.
+	enum class SamplerPreset {
+		NearestClamp,
+		NearestRepeat,
+		LinearClamp,
+		LinearRepeat,
+		TrilinearClamp,	///< Linear filtering between linear mip levels, use with mipmapped textures
+		TrilinearRepeat
+	};
+
 	[[nodiscard]]
-	GpuTexture uploadSurface(SDL_GPUDevice* gpuDevice, SDL_Surface* surface);
+	SDL_GPUSamplerCreateInfo samplerCreateInfo(SamplerPreset preset) noexcept;
 
+	[[nodiscard]]
+	inline GpuSampler createGpuSampler(SDL_GPUDevice* gpuDevice, SamplerPreset preset) {
+		return createGpuSampler(gpuDevice, samplerCreateInfo(preset));
+	}
+
+	/// @brief Creates a texture from the surface and uploads it in its own submission.
+	/// Use UploadQueue to upload many surfaces with one submission.
+	[[nodiscard]]
+	GpuTexture uploadSurface(SDL_GPUDevice* gpuDevice, SDL_Surface* surface, MipMode mipMode = MipMode::None);
+
+	/// @brief Reserves room for the surface in the atlas and uploads it in its own submission.
+	/// Use AtlasStaging to upload all blits of a frame with one submission.
 	[[nodiscard]]
 	SDL_Rect blitToGpuTexture(SDL_GPUDevice* gpuDevice, SDL_GPUTexture* texture, sdl::ImageAtlas& imageAtlas, SDL_Surface* surface, int border);
 
+	/// @brief Where an upload goes in the transfer buffer chunks of UploadQueue.
+	struct UploadPlacement {
+		Uint32 offset = 0;			// Offset in the chunk
+		Uint32 newChunkSize = 0;	// Size of the chunk to start first, 0 if the upload fits in the current chunk
+	};
+
+	/// @brief Places size bytes after the used bytes of the current chunk, at the alignment. If they do not fit,
+	/// they go at the start of a new chunk of chunkSize bytes, or of their own size if that is larger.
+	/// @param capacity Size of the current chunk, 0 if there is none
+	[[nodiscard]]
+	UploadPlacement placeUpload(Uint32 used, Uint32 capacity, Uint32 size, Uint32 alignment, Uint32 chunkSize) noexcept;
+
+	/// @brief Collects texture and buffer uploads and records all of them in one copy pass.
+	/// The data is copied into large mapped transfer buffers when queued, so the sources can be freed directly.
+	/// The destination textures and buffers are not owned, they must stay alive until the next record() or
+	/// submit(). This includes the textures returned by uploadSurface.
+	class UploadQueue {
+	public:
+		static constexpr Uint32 DefaultChunkSize = 8 * 1024 * 1024;
+
+		explicit UploadQueue(SDL_GPUDevice* gpuDevice, Uint32 chunkSize = DefaultChunkSize);
+
+		/// @brief Pending uploads not recorded are discarded.
+		~UploadQueue();
+
+		UploadQueue(const UploadQueue&) = delete;
+		UploadQueue& operator=(const UploadQueue&) = delete;
+
+		/// @brief Creates a sampler texture of the surface size and queues the surface upload.
+		/// With MipMode::Gpu the mip chain is generated by record(), after the copy pass.
+		/// The returned texture must not be dropped before the next record() or submit().
+		[[nodiscard]]
+		GpuTexture uploadSurface(SDL_Surface* surface, MipMode mipMode = MipMode::None);
+
+		/// @brief Creates a sampler texture with the surface as base level and the precomputed mip levels,
+		/// e.g. from generateMipChain, as level 1, 2, ... and queues all levels.
+		/// The returned texture must not be dropped before the next record() or submit().
+		[[nodiscard]]
+		GpuTexture uploadSurface(SDL_Surface* surface, std::span<const SdlSurface> mipLevels);
+
+		/// @brief Reserves room for the surface in the atlas and queues the upload to that rect of the texture.
+		SDL_Rect blitSurface(SDL_Surface* surface, SDL_GPUTexture* texture, ImageAtlas& imageAtlas, int border);
+
+		/// @brief Queues RGBA32 pixels to be copied to the region of the texture.
+		/// @param pixels First pixel of the region
+		/// @param pitch Bytes between two rows in pixels
+		/// @param texture Destination texture
+		/// @param rect Destination region
+		/// @param mipLevel Destination mip level
+		void uploadPixels(const void* pixels, int pitch, SDL_GPUTexture* texture, const SDL_Rect& rect, Uint32 mipLevel = 0);
+
+		/// @brief Queues an upload to the region of the texture and returns the mapped memory for it, to be
+		/// filled with tightly packed rows before record(). Lets data be read, e.g. from a file, straight
+		/// into the transfer buffer.
+		[[nodiscard]]
+		std::span<std::byte> mapPixels(SDL_GPUTexture* texture, const SDL_Rect& rect, Uint32 mipLevel = 0, Uint32 bytesPerPixel = 4);
+
+		/// @brief Queues the data to be copied to the buffer at the offset.
+		template <typename T>
+		void uploadBuffer(std::span<const T> data, SDL_GPUBuffer* buffer, Uint32 offset = 0) {
+			uploadBytes(std::as_bytes(data), buffer, offset);
+		}
+
+		void uploadBytes(std::span<const std::byte> data, SDL_GPUBuffer* buffer, Uint32 offset = 0);
+
+		[[nodiscard]]
+		SDL_GPUDevice* getGpuDevice() const noexcept {
+			return gpuDevice_;
+		}
+
+		[[nodiscard]]
+		bool isEmpty() const noexcept {
+			return textureUploads_.empty() && bufferUploads_.empty();
+		}
+
+		/// @brief Bytes queued since the last record, including alignment padding.
+		[[nodiscard]]
+		size_t getQueuedBytes() const noexcept {
+			return queuedBytes_;
+		}
+
+		/// @brief Records all queued uploads in one copy pass on the command buffer, e.g. the frame command buffer.
+		void record(SDL_GPUCommandBuffer* commandBuffer);
+
+		/// @brief Records all queued uploads on a new command buffer and submits it.
+		/// @return Fence signaled when the uploads are done, may be ignored if no one needs to wait
+		GpuFence submit();
+
+	private:
+		struct TextureUpload {
+			SDL_GPUTextureTransferInfo source;
+			SDL_GPUTextureRegion destination;
+		};
+
+		struct BufferUpload {
+			SDL_GPUTransferBufferLocation source;
+			SDL_GPUBufferRegion destination;
+		};
+
+		// Returns the mapped destination, the location is filled in with where it is.
+		std::byte* allocate(Uint32 size, Uint32 alignment, SDL_GPUTransferBuffer*& transferBuffer, Uint32& offset);
+
+		void unmap();
+
+		GpuTexture createTexture(SDL_Surface* surface, Uint32 levelCount, SDL_GPUTextureUsageFlags usage);
+
+		SDL_GPUDevice* gpuDevice_ = nullptr;
+		Uint32 chunkSize_ = 0;
+		std::vector<GpuTransferBuffer> transferBuffers_;
+		std::byte* mapped_ = nullptr;
+		Uint32 used_ = 0;
+		Uint32 capacity_ = 0;
+		size_t queuedBytes_ = 0;
+		std::vector<TextureUpload> textureUploads_;
+		std::vector<BufferUpload> bufferUploads_;
+		std::vector<SDL_GPUTexture*> mipmapTextures_;
+	};
+
+	enum class GrowthPolicy {
+		Exact,		// Exactly the required size
+		PowerOfTwo,	// The required size rounded up to a power of two
+		OneAndHalf	// 1.5 times the current capacity, at least the required size
+	};
+
+	/// @brief How a buffer grows when more space is required.
+	struct BufferGrowth {
+		GrowthPolicy policy = GrowthPolicy::PowerOfTwo;
+		size_t minSize = 0;
+		size_t maxSize = 0;		// Growth stops at maxSize, 0 means no cap. Larger requests get the exact size.
+	};
+
+	struct BufferStats {
+		size_t reallocations = 0;
+		size_t bytesAllocated = 0;	// Total over all allocations
+	};
+
+	/// @brief Returns the new capacity for a buffer needing the required size. Returns the current capacity
+	/// if it is already large enough.
+	[[nodiscard]]
+	size_t computeCapacity(size_t capacity, size_t required, const BufferGrowth& growth) noexcept;
+
 	class Buffer {
 	public:
+		explicit Buffer(const BufferGrowth& growth = {})
+			: growth_{growth} {
+		}
+
 		template <typename T>
 		[[nodiscard]]
 		SDL_GPUBuffer* get(SDL_GPUDevice* gpuDevice, SDL_GPUBufferUsageFlags flag, std::span<const T> data) {
 			if (!buffer_.get() || bytes_ < data.size_bytes()) {
-				bytes_ = data.size_bytes();
+				bytes_ = computeCapacity(buffer_ ? bytes_ : 0, data.size_bytes(), growth_);
 
 				SDL_GPUBufferCreateInfo vertexBufferInfo{
 					.usage = flag,
 					.size = static_cast<Uint32>(bytes_)
 				};
 				buffer_ = sdl::createGpuBuffer(gpuDevice, vertexBufferInfo);
+				++stats_.reallocations;
+				stats_.bytesAllocated += bytes_;
 			}
 			return buffer_.get();
 		}
@@ -36,29 +217,46 @@ namespace sdl {
 			return buffer_.get();
 		}
 
+		/// @brief Size of the GPU buffer, which may be larger than the data.
+		size_t getSize() const noexcept {
+			return bytes_;
+		}
+
+		const BufferStats& getStats() const noexcept {
+			return stats_;
+		}
+
 		void reset() {
 			bytes_ = 0;
 			buffer_.reset();
 		}
 
 	private:
+		BufferGrowth growth_;
+		BufferStats stats_;
 		size_t bytes_ = 0;
 		sdl::GpuBuffer buffer_;
 	};
 
 	class TransferBuffer {
 	public:
+		explicit TransferBuffer(const BufferGrowth& growth = {})
+			: growth_{growth} {
+		}
+
 		template <typename T>
 		[[nodiscard]]
 		SDL_GPUTransferBuffer* get(SDL_GPUDevice* gpuDevice, std::span<const T> data, bool cycle = false) {
 			if (!transferBuffer_.get() || bytes_ < data.size_bytes()) {
-				bytes_ = data.size_bytes();
+				bytes_ = computeCapacity(transferBuffer_ ? bytes_ : 0, data.size_bytes(), growth_);
 
 				SDL_GPUTransferBufferCreateInfo transferInfo{
 					.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
 					.size = static_cast<Uint32>(bytes_)
 				};
 				transferBuffer_ = sdl::createGpuTransferBuffer(gpuDevice, transferInfo);
+				++stats_.reallocations;
+				stats_.bytesAllocated += bytes_;
 			}
 			sdl::mapGpuTransferBuffer(gpuDevice, transferBuffer_.get(), data, cycle);
 			return transferBuffer_.get();
@@ -69,16 +267,120 @@ namespace sdl {
 			return transferBuffer_.get();
 		}
 
+		/// @brief Size of the transfer buffer, which may be larger than the data.
+		size_t getSize() const noexcept {
+			return bytes_;
+		}
+
+		const BufferStats& getStats() const noexcept {
+			return stats_;
+		}
+
 		void reset() {
 			bytes_ = 0;
 			transferBuffer_.reset();
 		}
 
 	private:
+		BufferGrowth growth_;
+		BufferStats stats_;
 		size_t bytes_ = 0;
 		sdl::GpuTransferBuffer transferBuffer_;
 	};
 
+	/// @brief Ring of persistently sized upload buffers, one slot per frame in flight.
+	/// Data pushed during a frame is sub-allocated from the slot's mapped transfer buffer and
+	/// copied to the slot's GPU buffer in a single copy pass by endFrame(). A slot is reused
+	/// only after the fence of its previous upload has signaled, so no buffer is cycled.
+	class StreamingBuffer {
+	public:
+		static constexpr int DefaultFramesInFlight = 3;
+		static constexpr Uint32 Alignment = 16;
+		static constexpr Uint32 MinCapacity = 64 * 1024;
+
+		struct Allocation {
+			Uint32 offset = 0;
+			Uint32 size = 0;
+		};
+
+		struct BatchAllocation {
+			Allocation vertices;
+			Allocation indices;
+		};
+
+		explicit StreamingBuffer(SDL_GPUBufferUsageFlags usage = SDL_GPU_BUFFERUSAGE_VERTEX | SDL_GPU_BUFFERUSAGE_INDEX,
+			int framesInFlight = DefaultFramesInFlight);
+
+		~StreamingBuffer();
+
+		StreamingBuffer(const StreamingBuffer&) = delete;
+		StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+
+		StreamingBuffer(StreamingBuffer&&) = delete;
+		StreamingBuffer& operator=(StreamingBuffer&&) = delete;
+
+		/// @brief Moves to the next slot, waiting for its previous upload to finish if needed.
+		void beginFrame(SDL_GPUDevice* gpuDevice);
+
+		/// @brief Copies the data into the current slot. Must be called between beginFrame() and endFrame().
+		/// @return The byte range in the slot's GPU buffer that will hold the data.
+		template <typename T>
+		Allocation push(std::span<const T> data) {
+			return pushBytes(data.data(), data.size_bytes());
+		}
+
+		template <VertexType Vertex, IndexType Index>
+		BatchAllocation push(const Batch<Vertex, Index>& batch) {
+			return {
+				.vertices = push(batch.vertices()),
+				.indices = push(batch.indices())
+			};
+		}
+
+		/// @brief Uploads all data pushed since beginFrame() using one command buffer and one copy pass.
+		/// Must be called before the command buffer drawing with the data is submitted.
+		void endFrame();
+
+		[[nodiscard]]
+		SDL_GPUBuffer* getBuffer() const noexcept {
+			return frames_[current_].buffer.get();
+		}
+
+		[[nodiscard]]
+		SDL_GPUBufferBinding getBinding(const Allocation& allocation) const noexcept {
+			return {
+				.buffer = getBuffer(),
+				.offset = allocation.offset
+			};
+		}
+
+		[[nodiscard]]
+		Uint32 getCapacity() const noexcept {
+			return capacity_;
+		}
+
+	private:
+		struct Frame {
+			sdl::GpuTransferBuffer transferBuffer;
+			sdl::GpuBuffer buffer;
+			sdl::GpuFence fence;
+			Uint32 transferCapacity = 0;
+			Uint32 bufferCapacity = 0;
+		};
+
+		Allocation pushBytes(const void* data, size_t bytes);
+
+		void grow(Uint32 required);
+
+		std::vector<Frame> frames_;
+		SDL_GPUBufferUsageFlags usage_ = 0;
+		SDL_GPUDevice* gpuDevice_ = nullptr;
+		std::byte* mapped_ = nullptr;
+		size_t current_ = 0;
+		Uint32 used_ = 0;
+		Uint32 capacity_ = 0;
+	};
+
 }
 
 #endif
@@ -1,90 +1,732 @@
 #include "imageatlas.h"
 
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+
 namespace sdl {
 
-	ImageAtlas::ImageAtlas() = default;
+	namespace {
+
+		bool intersects(const SDL_Rect& a, const SDL_Rect& b) noexcept {
+			return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+		}
+
+		bool containsRect(const SDL_Rect& outer, const SDL_Rect& inner) noexcept {
+			return inner.x >= outer.x && inner.y >= outer.y
+				&& inner.x + inner.w <= outer.x + outer.w && inner.y + inner.h <= outer.y + outer.h;
+		}
+
+		SDL_Rect innerRect(SDL_Rect rect, int border) noexcept {
+			rect.w -= 2 * border;
+			rect.h -= 2 * border;
+			rect.x += border;
+			rect.y += border;
+			return rect;
+		}
+
+		std::vector<size_t> batchOrder(std::span<const AtlasSize> sizes, AtlasSort sort) {
+			std::vector<size_t> order(sizes.size());
+			for (size_t i = 0; i < order.size(); ++i) {
+				order[i] = i;
+			}
+			auto key = [&](size_t index) -> std::pair<int64_t, int64_t> {
+				const auto [width, height] = sizes[index];
+				switch (sort) {
+					case AtlasSort::Height:
+						return {height, width};
+					case AtlasSort::Area:
+						return {static_cast<int64_t>(width) * height, std::max(width, height)};
+					case AtlasSort::MaxSide:
+						return {std::max(width, height), std::min(width, height)};
+					default:
+						return {0, 0};
+				}
+			};
+			std::ranges::stable_sort(order, std::ranges::greater{}, key);
+			return order;
+		}
+
+		// Lower is closer to the top of the atlas.
+		std::pair<int, int> packingOrder(const SDL_Rect& rect) noexcept {
+			return {rect.y + rect.h, rect.x};
+		}
+
+	}
+
+	ImageAtlas::ImageAtlas() {
+		reset();
+	}
+
+	ImageAtlas::ImageAtlas(int width, int height, AtlasPacking packing)
+		: width_{width}
+		, height_{height}
+		, packing_{packing} {
 
-	ImageAtlas::ImageAtlas(int width, int height)
-		: root_{SDL_Rect{0, 0, width, height}} {
+		reset();
 	}
 
 	std::optional<SDL_Rect> ImageAtlas::add(int width, int height, int border) {
-		if (width > root_.rect_.w || height > root_.rect_.h) {
+		if (auto handle = insertEntry(width, height, border, true)) {
+			return getRect(*handle);
+		}
+		return std::nullopt;
+	}
+
+	AtlasBatchResult ImageAtlas::addBatch(std::span<const AtlasSize> sizes, int border, AtlasSort sort) {
+		if (sort == AtlasSort::Best) {
+			// Each order is tried on a copy, the best copy replaces the atlas.
+			std::optional<ImageAtlas> best;
+			AtlasBatchResult bestResult;
+			int64_t bestArea = -1;
+			for (auto candidate : {AtlasSort::MaxSide, AtlasSort::Height, AtlasSort::Area}) {
+				ImageAtlas atlas = *this;
+				auto result = atlas.addBatch(sizes, border, candidate);
+				if (atlas.usedArea_ > bestArea) {
+					bestArea = atlas.usedArea_;
+					best = std::move(atlas);
+					bestResult = std::move(result);
+				}
+			}
+			*this = std::move(*best);
+			return bestResult;
+		}
+
+		AtlasBatchResult result{
+			.rects = std::vector<std::optional<SDL_Rect>>(sizes.size()),
+			.sort = sort
+		};
+		for (auto index : batchOrder(sizes, sort)) {
+			result.rects[index] = add(sizes[index].width, sizes[index].height, border);
+			if (result.rects[index]) {
+				++result.placedCount;
+			}
+		}
+		result.occupancy = getOccupancy();
+		return result;
+	}
+
+	std::optional<AtlasHandle> ImageAtlas::insert(int width, int height, int border) {
+		return insertEntry(width, height, border, false);
+	}
+
+	bool ImageAtlas::remove(AtlasHandle handle) {
+		if (!findEntry(handle) || entries_[handle.index].pinned) {
+			return false;
+		}
+		auto& entry = entries_[handle.index];
+		release(entry.allocation);
+		usedArea_ -= static_cast<int64_t>(entry.allocation.rect.w) * entry.allocation.rect.h;
+		--size_;
+		entry.used = false;
+		++entry.generation;
+		freeEntries_.push_back(handle.index);
+		return true;
+	}
+
+	std::optional<SDL_Rect> ImageAtlas::getRect(AtlasHandle handle) const {
+		if (auto entry = findEntry(handle)) {
+			return innerRect(entry->allocation.rect, entry->border);
+		}
+		return std::nullopt;
+	}
+
+	bool ImageAtlas::contains(AtlasHandle handle) const noexcept {
+		return findEntry(handle) != nullptr;
+	}
+
+	std::vector<AtlasMove> ImageAtlas::defragment(size_t maxMoves, const std::function<bool(int width, int height)>& reserve) {
+		std::vector<AtlasMove> moves;
+		std::vector<uint32_t> candidates;
+		for (uint32_t i = 0; i < entries_.size(); ++i) {
+			if (entries_[i].used && !entries_[i].pinned) {
+				candidates.push_back(i);
+			}
+		}
+		std::ranges::sort(candidates, std::ranges::greater{}, [this](uint32_t index) {
+			return packingOrder(entries_[index].allocation.rect);
+		});
+
+		// The sources are released after all moves are planned, so no move lands on the source of another.
+		// The number of attempts is bounded, each costs a search of the free space. Only an attempt moving
+		// the image up is placed, so a rejected attempt changes nothing.
+		std::vector<Allocation> sources;
+		const size_t maxAttempts = std::min(candidates.size(), maxMoves * 8);
+		for (size_t i = 0; i < maxAttempts && moves.size() < maxMoves; ++i) {
+			auto& entry = entries_[candidates[i]];
+			const SDL_Rect from = entry.allocation.rect;
+			const auto to = findFree(from.w, from.h);
+			if (!to || packingOrder(*to) >= packingOrder(from) || (reserve && !reserve(from.w, from.h))) {
+				continue;
+			}
+			auto allocation = allocate(from.w, from.h);
+			if (!allocation) {
+				continue;
+			}
+			moves.push_back(AtlasMove{
+				.handle = AtlasHandle{candidates[i], entry.generation},
+				.from = innerRect(from, entry.border),
+				.to = innerRect(allocation->rect, entry.border),
+				.border = entry.border
+			});
+			sources.push_back(entry.allocation);
+			entry.allocation = *allocation;
+		}
+		for (const auto& source : sources) {
+			release(source);
+		}
+		return moves;
+	}
+
+	void ImageAtlas::grow(int width, int height) {
+		if (width < width_ || height < height_) {
+			throw std::invalid_argument{fmt::format("ImageAtlas can not shrink from {}x{} to {}x{}", width_, height_, width, height)};
+		}
+		if (width == width_ && height == height_) {
+			return;
+		}
+
+		switch (packing_) {
+			case AtlasPacking::BinaryTree:
+				if (nodes_[0].left == NoNode && !nodes_[0].image) {
+					nodes_[0].rect = SDL_Rect{0, 0, width, height};
+					break;
+				}
+				if (width > width_) {
+					wrapRoot(SDL_Rect{0, 0, width, height_}, SDL_Rect{width_, 0, width - width_, height_});
+				}
+				if (height > height_) {
+					wrapRoot(SDL_Rect{0, 0, width, height}, SDL_Rect{0, height_, width, height - height_});
+				}
+				break;
+			case AtlasPacking::Skyline:
+				if (width > width_) {
+					skyline_.push_back(SkylineSegment{.x = width_, .y = 0, .width = width - width_});
+					if (skyline_[skyline_.size() - 2].y == 0) {
+						skyline_[skyline_.size() - 2].width += skyline_.back().width;
+						skyline_.pop_back();
+					}
+				}
+				break;
+			case AtlasPacking::MaxRects:
+				// Free rects reaching the old edges extend into the new space.
+				for (auto& freeRect : freeRects_) {
+					if (freeRect.x + freeRect.w == width_) {
+						freeRect.w = width - freeRect.x;
+					}
+					if (freeRect.y + freeRect.h == height_) {
+						freeRect.h = height - freeRect.y;
+					}
+				}
+				if (width > width_) {
+					addFreeRect(SDL_Rect{width_, 0, width - width_, height});
+				}
+				if (height > height_) {
+					addFreeRect(SDL_Rect{0, height_, width, height - height_});
+				}
+				break;
+		}
+		width_ = width;
+		height_ = height;
+	}
+
+	int ImageAtlas::getWidth() const noexcept {
+		return width_;
+	}
+
+	int ImageAtlas::getHeight() const noexcept {
+		return height_;
+	}
+
+	float ImageAtlas::getOccupancy() const noexcept {
+		const auto area = static_cast<int64_t>(width_) * height_;
+		return area > 0 ? static_cast<float>(static_cast<double>(usedArea_) / static_cast<double>(area)) : 0.f;
+	}
+
+	void ImageAtlas::reset() {
+		usedArea_ = 0;
+		size_ = 0;
+		entries_.clear();
+		freeEntries_.clear();
+		nodes_.clear();
+		freeNodePairs_.clear();
+		skyline_.clear();
+		freeRects_.clear();
+		freeSpaceFragmented_ = false;
+		switch (packing_) {
+			case AtlasPacking::BinaryTree:
+				nodes_.push_back(Node{.rect = SDL_Rect{0, 0, width_, height_}});
+				break;
+			case AtlasPacking::Skyline:
+				skyline_.push_back(SkylineSegment{.x = 0, .y = 0, .width = width_});
+				break;
+			case AtlasPacking::MaxRects:
+				freeRects_.push_back(SDL_Rect{0, 0, width_, height_});
+				break;
+		}
+	}
+
+	std::optional<ImageAtlas::Allocation> ImageAtlas::allocate(int width, int height) {
+		switch (packing_) {
+			case AtlasPacking::BinaryTree:
+				return insertBinaryTree(width, height);
+			case AtlasPacking::Skyline:
+				if (auto rect = insertSkyline(width, height)) {
+					return Allocation{.rect = *rect};
+				}
+				return std::nullopt;
+			case AtlasPacking::MaxRects:
+				if (auto rect = insertMaxRects(width, height)) {
+					return Allocation{.rect = *rect};
+				}
+				return std::nullopt;
+		}
+		return std::nullopt;
+	}
+
+	void ImageAtlas::release(const Allocation& allocation) {
+		switch (packing_) {
+			case AtlasPacking::BinaryTree:
+				removeBinaryTree(allocation.node);
+				break;
+			case AtlasPacking::Skyline:
+				[[fallthrough]];
+			case AtlasPacking::MaxRects:
+				addFreeRect(allocation.rect);
+				break;
+		}
+	}
+
+	std::optional<SDL_Rect> ImageAtlas::findFree(int width, int height) {
+		switch (packing_) {
+			case AtlasPacking::BinaryTree:
+				return findBinaryTree(width, height);
+			case AtlasPacking::Skyline:
+				// Space freed below the skyline is used first, as by insertSkyline().
+				if (auto rect = findMaxRects(width, height)) {
+					return rect;
+				}
+				if (auto position = findSkyline(width, height)) {
+					return position->rect;
+				}
+				return std::nullopt;
+			case AtlasPacking::MaxRects:
+				return findMaxRects(width, height);
+		}
+		return std::nullopt;
+	}
+
+	std::optional<AtlasHandle> ImageAtlas::insertEntry(int width, int height, int border, bool pinned) {
+		const int paddedWidth = width + 2 * border;
+		const int paddedHeight = height + 2 * border;
+		if (paddedWidth > width_ || paddedHeight > height_) {
 			// Image to large!
 			return std::nullopt;
 		}
-		auto node = root_.insert(SDL_Rect{0, 0, width, height}, border);
-		if (!node) {
-			// // Not enough image space to insert image.
+		auto allocation = allocate(paddedWidth, paddedHeight);
+		if (!allocation && freeSpaceFragmented_) {
+			// Freed space the free rects missed, recovered only now, as the rebuild costs much more than an insert.
+			rebuildFreeSpace();
+			allocation = allocate(paddedWidth, paddedHeight);
+		}
+		if (!allocation) {
+			// Not enough image space to insert image.
 			return std::nullopt;
 		}
+		usedArea_ += static_cast<int64_t>(paddedWidth) * paddedHeight;
+		++size_;
 
-		// Only when atlas is not full.
-		SDL_Rect rect = node->rect_;
-		rect.w -= 2 * border;
-		rect.h -= 2 * border;
-		rect.x += border;
-		rect.y += border;
-		return std::make_optional<SDL_Rect>(rect);
+		uint32_t index = static_cast<uint32_t>(entries_.size());
+		if (freeEntries_.empty()) {
+			entries_.emplace_back();
+		} else {
+			index = freeEntries_.back();
+			freeEntries_.pop_back();
+		}
+		auto& entry = entries_[index];
+		entry.allocation = *allocation;
+		entry.border = border;
+		entry.used = true;
+		entry.pinned = pinned;
+		return AtlasHandle{index, entry.generation};
 	}
 
-	int ImageAtlas::getWidth() const noexcept {
-		return root_.rect_.w;
+	const ImageAtlas::Entry* ImageAtlas::findEntry(AtlasHandle handle) const noexcept {
+		if (handle.index >= entries_.size()) {
+			return nullptr;
+		}
+		const auto& entry = entries_[handle.index];
+		return entry.used && entry.generation == handle.generation ? &entry : nullptr;
 	}
 
-	int ImageAtlas::getHeight() const noexcept {
-		return root_.rect_.h;
+	int ImageAtlas::allocateNodePair() {
+		if (freeNodePairs_.empty()) {
+			nodes_.resize(nodes_.size() + 2);
+			return static_cast<int>(nodes_.size()) - 2;
+		}
+		const int left = freeNodePairs_.back();
+		freeNodePairs_.pop_back();
+		return left;
 	}
 
+	void ImageAtlas::wrapRoot(const SDL_Rect& rect, const SDL_Rect& rest) {
+		const int left = allocateNodePair();
+		nodes_[left] = nodes_[0];
+		nodes_[left].parent = 0;
+		if (const int child = nodes_[left].left; child != NoNode) {
+			nodes_[child].parent = left;
+			nodes_[child + 1].parent = left;
+		}
+		nodes_[left + 1] = Node{.rect = rest, .parent = 0};
+		nodes_[0] = Node{.rect = rect, .left = left};
+		for (auto& entry : entries_) {
+			if (entry.used && entry.allocation.node == 0) {
+				entry.allocation.node = left;
+			}
+		}
+	}
 
-	ImageAtlas::Node::Node(const SDL_Rect& rect)
-		: rect_{rect} {
+	std::optional<SDL_Rect> ImageAtlas::findBinaryTree(int width, int height) {
+		// The leaf insertBinaryTree() splits, the image goes to its top left corner.
+		stack_.clear();
+		stack_.push_back(0);
+		while (!stack_.empty()) {
+			const Node& node = nodes_[stack_.back()];
+			stack_.pop_back();
+			if (node.full) {
+				continue;
+			}
+			if (node.left != NoNode) {
+				stack_.push_back(node.left + 1);
+				stack_.push_back(node.left);
+				continue;
+			}
+			if (width <= node.rect.w && height <= node.rect.h) {
+				return SDL_Rect{node.rect.x, node.rect.y, width, height};
+			}
+		}
+		return std::nullopt;
 	}
 
-	ImageAtlas::Node* ImageAtlas::Node::insert(const SDL_Rect& surface, int border) {
-		// Is not a leaf!
-		if (left_ != nullptr && right_ != nullptr) {
-			if (auto node = left_->insert(surface, border); node != nullptr) {
-				// Image inserted.
-				return node;
+	std::optional<ImageAtlas::Allocation> ImageAtlas::insertBinaryTree(int width, int height) {
+		// Depth first, left before right, the same order as the recursive Blackpawn insert.
+		// Filled subtrees are skipped.
+		stack_.clear();
+		stack_.push_back(0);
+		while (!stack_.empty()) {
+			const int index = stack_.back();
+			stack_.pop_back();
+			if (nodes_[index].full) {
+				continue;
 			}
-			// Image did not fit, try the other node.
-			return right_->insert(surface, border);
-		} else {
-			if (image) {
-				// Node is already filled!
-				return nullptr;
+
+			if (nodes_[index].left != NoNode) {
+				// Is not a leaf!
+				stack_.push_back(nodes_[index].left + 1);
+				stack_.push_back(nodes_[index].left);
+				continue;
 			}
 
-			if (surface.w + 2 * border > rect_.w || surface.h + 2 * border > rect_.h) {
+			const SDL_Rect rect = nodes_[index].rect;
+			if (width > rect.w || height > rect.h) {
 				// Image to large!
-				return nullptr;
+				continue;
 			}
 
 			// Fits perfectly?
-			if (surface.w + 2 * border == rect_.w && surface.h + 2 * border == rect_.h) {
-				image = true;
-				return this;
+			if (width == rect.w && height == rect.h) {
+				nodes_[index].image = true;
+				nodes_[index].full = true;
+				// Parents whose both children are filled are skipped by the following inserts.
+				for (int child = index; child != 0;) {
+					const int parent = nodes_[child].parent;
+					const int left = nodes_[parent].left;
+					if (!nodes_[left].full || !nodes_[left + 1].full) {
+						break;
+					}
+					nodes_[parent].full = true;
+					child = parent;
+				}
+				return Allocation{.rect = rect, .node = index};
 			}
 
-			// Split the node in half.
-			if (rect_.w - surface.w < rect_.h - surface.h) { // Split vertical.
-				left_ = std::make_unique<Node>(SDL_Rect{rect_.x, rect_.y,
-					rect_.w, surface.h + 2 * border}); // Up.
+			// Split the node in two, the image is inserted in the first.
+			const int left = allocateNodePair();
+			nodes_[index].left = left;
+			if (rect.w - width < rect.h - height) { // Split vertical.
+				nodes_[left] = Node{.rect = SDL_Rect{rect.x, rect.y, rect.w, height}, .parent = index}; // Up.
+				nodes_[left + 1] = Node{.rect = SDL_Rect{rect.x, rect.y + height, rect.w, rect.h - height}, .parent = index}; // Down.
+			} else { // Split horizontal.
+				nodes_[left] = Node{.rect = SDL_Rect{rect.x, rect.y, width, rect.h}, .parent = index}; // Left.
+				nodes_[left + 1] = Node{.rect = SDL_Rect{rect.x + width, rect.y, rect.w - width, rect.h}, .parent = index}; // Right.
+			}
+			stack_.push_back(left);
+		}
+		return std::nullopt;
+	}
+
+	void ImageAtlas::removeBinaryTree(int node) {
+		nodes_[node].image = false;
+		for (int index = node; index != NoNode; index = nodes_[index].parent) {
+			nodes_[index].full = false;
+		}
 
-				right_ = std::make_unique<Node>(SDL_Rect{rect_.x, rect_.y + surface.h + 2 * border,
-					rect_.w, rect_.h - surface.h - 2 * border}); // Down.
+		// Collapse the parents whose both children are empty leaves.
+		for (int index = nodes_[node].parent; index != NoNode; index = nodes_[index].parent) {
+			const int left = nodes_[index].left;
+			const auto isEmptyLeaf = [&](const Node& child) {
+				return child.left == NoNode && !child.image;
+			};
+			if (!isEmptyLeaf(nodes_[left]) || !isEmptyLeaf(nodes_[left + 1])) {
+				break;
+			}
+			nodes_[index].left = NoNode;
+			freeNodePairs_.push_back(left);
+		}
+	}
 
-			} else { // Split horizontal.
-				left_ = std::make_unique<Node>(SDL_Rect{rect_.x, rect_.y,
-					surface.w + 2 * border, rect_.h}); // Left.
+	std::optional<ImageAtlas::SkylinePosition> ImageAtlas::findSkyline(int width, int height) const {
+		size_t bestIndex = skyline_.size();
+		int bestTop = std::numeric_limits<int>::max();
+		int bestWidth = std::numeric_limits<int>::max();
+		int bestY = 0;
+		for (size_t i = 0; i < skyline_.size(); ++i) {
+			if (auto y = skylineFit(i, width, height)) {
+				const int top = *y + height;
+				if (top < bestTop || (top == bestTop && skyline_[i].width < bestWidth)) {
+					bestIndex = i;
+					bestTop = top;
+					bestWidth = skyline_[i].width;
+					bestY = *y;
+				}
+			}
+		}
+		if (bestIndex == skyline_.size()) {
+			return std::nullopt;
+		}
+		return SkylinePosition{
+			.index = bestIndex,
+			.rect = SDL_Rect{skyline_[bestIndex].x, bestY, width, height}
+		};
+	}
+
+	std::optional<SDL_Rect> ImageAtlas::insertSkyline(int width, int height) {
+		// Space freed below the skyline is used first.
+		if (!freeRects_.empty()) {
+			if (auto rect = insertMaxRects(width, height)) {
+				return rect;
+			}
+		}
+		auto position = findSkyline(width, height);
+		if (!position) {
+			return std::nullopt;
+		}
+		skylineAdd(position->index, position->rect);
+		return position->rect;
+	}
+
+	std::optional<int> ImageAtlas::skylineFit(size_t index, int width, int height) const {
+		if (skyline_[index].x + width > width_) {
+			return std::nullopt;
+		}
+		int y = skyline_[index].y;
+		for (int widthLeft = width; widthLeft > 0; ++index) {
+			y = std::max(y, skyline_[index].y);
+			if (y + height > height_) {
+				return std::nullopt;
+			}
+			widthLeft -= skyline_[index].width;
+		}
+		return y;
+	}
+
+	void ImageAtlas::skylineAdd(size_t index, const SDL_Rect& rect) {
+		skyline_.insert(skyline_.begin() + index, SkylineSegment{.x = rect.x, .y = rect.y + rect.h, .width = rect.w});
 
-				right_ = std::make_unique<Node>(SDL_Rect{rect_.x + surface.w + 2 * border, rect_.y,
-					rect_.w - surface.w - 2 * border, rect_.h}); // Right.
+		// Shrink or remove the segments now below the new one.
+		const int right = rect.x + rect.w;
+		for (size_t i = index + 1; i < skyline_.size() && skyline_[i].x < right;) {
+			const int shrink = right - skyline_[i].x;
+			if (skyline_[i].width <= shrink) {
+				skyline_.erase(skyline_.begin() + i);
+			} else {
+				skyline_[i].x += shrink;
+				skyline_[i].width -= shrink;
+				break;
 			}
+		}
 
-			// Insert the image in the left node.
-			return left_->insert(surface, border);
+		// Merge neighbours of the same height.
+		for (size_t i = 0; i + 1 < skyline_.size();) {
+			if (skyline_[i].y == skyline_[i + 1].y) {
+				skyline_[i].width += skyline_[i + 1].width;
+				skyline_.erase(skyline_.begin() + i + 1);
+			} else {
+				++i;
+			}
+		}
+	}
+
+	void ImageAtlas::addFreeRect(const SDL_Rect& rect) {
+		// Two free rects overlapping or touching side by side also free the rect spanning both, over the part
+		// where they are side by side. Such rects are formed from the freed rect and the free rects it touches,
+		// and again from each formed rect not inside an existing free rect. Free space only joined through
+		// used space freed earlier may be missed, it is recovered by rebuildFreeSpace().
+		freeSpaceFragmented_ = true;
+		auto& pending = joinedRects_;
+		pending.assign(1, rect);
+		while (!pending.empty()) {
+			const SDL_Rect added = pending.back();
+			pending.pop_back();
+			if (std::ranges::any_of(freeRects_, [&](const SDL_Rect& freeRect) { return containsRect(freeRect, added); })) {
+				continue;
+			}
+			std::erase_if(freeRects_, [&](const SDL_Rect& freeRect) { return containsRect(added, freeRect); });
+
+			for (const auto& freeRect : freeRects_) {
+				const int left = std::max(freeRect.x, added.x);
+				const int right = std::min(freeRect.x + freeRect.w, added.x + added.w);
+				const int top = std::max(freeRect.y, added.y);
+				const int bottom = std::min(freeRect.y + freeRect.h, added.y + added.h);
+				const auto join = [&](const SDL_Rect& joined) {
+					if (!containsRect(freeRect, joined) && !containsRect(added, joined)) {
+						pending.push_back(joined);
+					}
+				};
+				if (left <= right && top < bottom) {
+					// Side by side horizontally.
+					const int x = std::min(freeRect.x, added.x);
+					join(SDL_Rect{x, top, std::max(freeRect.x + freeRect.w, added.x + added.w) - x, bottom - top});
+				}
+				if (top <= bottom && left < right) {
+					// Side by side vertically.
+					const int y = std::min(freeRect.y, added.y);
+					join(SDL_Rect{left, y, right - left, std::max(freeRect.y + freeRect.h, added.y + added.h) - y});
+				}
+			}
+			freeRects_.push_back(added);
+		}
+	}
+
+	void ImageAtlas::rebuildFreeSpace() {
+		freeSpaceFragmented_ = false;
+
+		std::vector<SDL_Rect> usedRects;
+		usedRects.reserve(size_);
+		for (const auto& entry : entries_) {
+			if (entry.used) {
+				usedRects.push_back(entry.allocation.rect);
+			}
+		}
+
+		freeRects_.assign(1, SDL_Rect{0, 0, width_, height_});
+		if (packing_ == AtlasPacking::Skyline) {
+			// The skyline is the top of the used rects, the space below it not used is kept as free rects.
+			std::vector<int> edges{0, width_};
+			for (const auto& rect : usedRects) {
+				edges.push_back(rect.x);
+				edges.push_back(rect.x + rect.w);
+			}
+			std::ranges::sort(edges);
+			const auto [first, last] = std::ranges::unique(edges);
+			edges.erase(first, last);
+
+			skyline_.clear();
+			for (size_t i = 0; i + 1 < edges.size(); ++i) {
+				const int x = edges[i];
+				const int right = edges[i + 1];
+				int y = 0;
+				for (const auto& rect : usedRects) {
+					if (rect.x <= x && right <= rect.x + rect.w) {
+						y = std::max(y, rect.y + rect.h);
+					}
+				}
+				if (!skyline_.empty() && skyline_.back().y == y) {
+					skyline_.back().width += right - x;
+				} else {
+					skyline_.push_back(SkylineSegment{.x = x, .y = y, .width = right - x});
+				}
+			}
+			for (const auto& segment : skyline_) {
+				maxRectsPlace(SDL_Rect{segment.x, segment.y, segment.width, height_ - segment.y});
+			}
+		}
+		for (const auto& rect : usedRects) {
+			maxRectsPlace(rect);
+		}
+	}
+
+	std::optional<SDL_Rect> ImageAtlas::findMaxRects(int width, int height) const {
+		const SDL_Rect* best = nullptr;
+		std::tuple bestScore{std::numeric_limits<int>::max(), std::numeric_limits<int>::max()};
+		for (const auto& freeRect : freeRects_) {
+			if (freeRect.w >= width && freeRect.h >= height) {
+				const int leftoverWidth = freeRect.w - width;
+				const int leftoverHeight = freeRect.h - height;
+				std::tuple score{std::min(leftoverWidth, leftoverHeight), std::max(leftoverWidth, leftoverHeight)};
+				if (score < bestScore) {
+					best = &freeRect;
+					bestScore = score;
+				}
+			}
+		}
+		if (!best) {
+			return std::nullopt;
+		}
+		return SDL_Rect{best->x, best->y, width, height};
+	}
+
+	std::optional<SDL_Rect> ImageAtlas::insertMaxRects(int width, int height) {
+		auto rect = findMaxRects(width, height);
+		if (rect) {
+			maxRectsPlace(*rect);
+		}
+		return rect;
+	}
+
+	void ImageAtlas::maxRectsPlace(const SDL_Rect& rect) {
+		// Split every free rect overlapping the placed rect into the maximal rects around it.
+		const size_t count = freeRects_.size();
+		size_t kept = 0;
+		for (size_t i = 0; i < count; ++i) {
+			const SDL_Rect freeRect = freeRects_[i];
+			if (!intersects(freeRect, rect)) {
+				freeRects_[kept++] = freeRect;
+				continue;
+			}
+			if (rect.x > freeRect.x) {
+				freeRects_.push_back({freeRect.x, freeRect.y, rect.x - freeRect.x, freeRect.h});
+			}
+			if (rect.x + rect.w < freeRect.x + freeRect.w) {
+				freeRects_.push_back({rect.x + rect.w, freeRect.y, freeRect.x + freeRect.w - rect.x - rect.w, freeRect.h});
+			}
+			if (rect.y > freeRect.y) {
+				freeRects_.push_back({freeRect.x, freeRect.y, freeRect.w, rect.y - freeRect.y});
+			}
+			if (rect.y + rect.h < freeRect.y + freeRect.h) {
+				freeRects_.push_back({freeRect.x, rect.y + rect.h, freeRect.w, freeRect.y + freeRect.h - rect.y - rect.h});
+			}
+		}
+		const size_t firstSplit = kept;
+		freeRects_.erase(freeRects_.begin() + kept, freeRects_.begin() + count);
+
+		// Only the new rects can be contained in another, the untouched ones were maximal already.
+		for (size_t i = firstSplit; i < freeRects_.size();) {
+			bool redundant = false;
+			for (size_t j = 0; j < freeRects_.size() && !redundant; ++j) {
+				// Of two equal new rects, only the later one is removed.
+				redundant = j != i && containsRect(freeRects_[j], freeRects_[i])
+					&& (j < firstSplit || !containsRect(freeRects_[i], freeRects_[j]) || j < i);
+			}
+			if (redundant) {
+				freeRects_[i] = freeRects_.back();
+				freeRects_.pop_back();
+			} else {
+				++i;
+			}
 		}
 	}
 
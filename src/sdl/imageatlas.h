@@ -3,38 +3,208 @@
 
 #include <SDL3/SDL_rect.h>
 
-#include <memory>
+#include <compare>
+#include <cstdint>
+#include <functional>
 #include <optional>
+#include <span>
+#include <vector>
 
 namespace sdl {
 
-	// The packing algorithm is from http://www.blackpawn.com/texts/lightmaps/default.html.
+	// The order images of a batch are packed in, largest first.
+	enum class AtlasSort {
+		None,		// Input order
+		Height,
+		Area,
+		MaxSide,	// The longer side of the image
+		Best		// Packs with each of the orders above and keeps the one with the most area placed
+	};
+
+	struct AtlasSize {
+		int width = 0;
+		int height = 0;
+	};
+
+	struct AtlasBatchResult {
+		std::vector<std::optional<SDL_Rect>> rects;	// In input order, std::nullopt for the images not fitting
+		size_t placedCount = 0;
+		float occupancy = 0.f;		// Of the atlas after the batch, see ImageAtlas::getOccupancy()
+		AtlasSort sort = AtlasSort::None;	// The order used, differs from the requested one for AtlasSort::Best
+	};
+
+	// Identifies an image inserted in an ImageAtlas. A removed handle is never valid again.
+	struct AtlasHandle {
+		uint32_t index = 0;
+		uint32_t generation = 0;
+
+		friend auto operator<=>(const AtlasHandle&, const AtlasHandle&) = default;
+	};
+
+	// An image moved by ImageAtlas::defragment(). The rects are inside the border, as returned by getRect().
+	struct AtlasMove {
+		AtlasHandle handle;
+		SDL_Rect from{};
+		SDL_Rect to{};
+		int border = 0;
+	};
+
+	enum class AtlasPacking {
+		// Binary tree from http://www.blackpawn.com/texts/lightmaps/default.html.
+		BinaryTree,
+		// Skyline bottom-left, fast and good for images of similar height, e.g. glyphs.
+		Skyline,
+		// MaxRects best short side fit, the densest but the slowest insert.
+		MaxRects
+	};
+
+	// Packs rectangles into a fixed size area. All strategies keep their state in contiguous vectors.
 	class ImageAtlas {
 	public:
 		ImageAtlas();
 
-		ImageAtlas(int width, int height);
-		
+		ImageAtlas(int width, int height, AtlasPacking packing = AtlasPacking::BinaryTree);
+
+		// Returns the rect of the image inside the border, or std::nullopt if the atlas has no space left.
+		// The image can not be removed and is never moved by defragment().
 		std::optional<SDL_Rect> add(int width, int height, int border = 0);
 
+		// Adds all images at once, sorted to pack denser than adding them one at a time in arrival order.
+		// The images are added as by add().
+		AtlasBatchResult addBatch(std::span<const AtlasSize> sizes, int border = 0, AtlasSort sort = AtlasSort::Best);
+
+		// Inserts an image which can be removed and moved, or returns std::nullopt if the atlas has no space left.
+		std::optional<AtlasHandle> insert(int width, int height, int border = 0);
+
+		// Frees the space of the image, which is joined with the free space next to it. Free space not joined
+		// this way is recovered by the first insert that does not fit otherwise. Returns false if the handle is
+		// not valid.
+		bool remove(AtlasHandle handle);
+
+		// The rect of the image inside the border, or std::nullopt if the handle is not valid.
+		std::optional<SDL_Rect> getRect(AtlasHandle handle) const;
+
+		bool contains(AtlasHandle handle) const noexcept;
+
+		// Moves up to maxMoves inserted images, the ones furthest down first, to free space higher up in the
+		// atlas, so that the free space gathers at the bottom. A move is planned only when reserve, if set,
+		// accepts the padded size of the image, e.g. to reserve room in a staging texture. No destination
+		// overlaps the source of any move in the same call, so all moves can be copied in any order.
+		// Returns the moves, empty when no image found a better place.
+		std::vector<AtlasMove> defragment(size_t maxMoves, const std::function<bool(int width, int height)>& reserve = nullptr);
+
+		// Enlarges the atlas to the size, the images keep their place. Throws std::invalid_argument if
+		// the size is smaller than the current size.
+		void grow(int width, int height);
+
+		// Number of images in the atlas.
+		size_t getSize() const noexcept {
+			return size_;
+		}
+
 		int getWidth() const noexcept;
 
 		int getHeight() const noexcept;
 
+		AtlasPacking getPacking() const noexcept {
+			return packing_;
+		}
+
+		// The area of the added rects, including the borders.
+		int64_t getUsedArea() const noexcept {
+			return usedArea_;
+		}
+
+		// The used part of the atlas area, between 0 and 1.
+		float getOccupancy() const noexcept;
+
 	private:
+		static constexpr int NoNode = -1;
+
 		struct Node {
-			Node(const SDL_Rect& rect);
+			SDL_Rect rect{};
+			int left = NoNode;	// The right child is always left + 1
+			bool image = false;
+			bool full = false;	// The node or all leaves below it are filled
+			int parent = NoNode;
+		};
 
-			Node* insert(const SDL_Rect& surface, int border);
+		// The padded space of an image.
+		struct Allocation {
+			SDL_Rect rect{};
+			int node = NoNode;
+		};
 
-			bool image = false;
-			std::unique_ptr<Node> left_;
-			std::unique_ptr<Node> right_;
-			
-			SDL_Rect rect_{};
+		struct Entry {
+			Allocation allocation;
+			int border = 0;
+			uint32_t generation = 0;
+			bool used = false;
+			bool pinned = false;
+		};
+
+		struct SkylineSegment {
+			int x = 0;
+			int y = 0;
+			int width = 0;
+		};
+
+		struct SkylinePosition {
+			size_t index = 0;	// The segment the rect is placed at
+			SDL_Rect rect{};
 		};
 
-		Node root_{SDL_Rect{0, 0, 2048, 2048}};
+		void reset();
+
+		std::optional<Allocation> allocate(int width, int height);
+		void release(const Allocation& allocation);
+		// Returns the rect allocate() would return, without placing it.
+		std::optional<SDL_Rect> findFree(int width, int height);
+
+		std::optional<AtlasHandle> insertEntry(int width, int height, int border, bool pinned);
+		const Entry* findEntry(AtlasHandle handle) const noexcept;
+
+		int allocateNodePair();
+		// Makes the current root the first child of a new root of the rect, the second child is the rest.
+		void wrapRoot(const SDL_Rect& rect, const SDL_Rect& rest);
+
+		std::optional<SDL_Rect> findBinaryTree(int width, int height);
+		std::optional<SkylinePosition> findSkyline(int width, int height) const;
+		std::optional<SDL_Rect> findMaxRects(int width, int height) const;
+
+		std::optional<Allocation> insertBinaryTree(int width, int height);
+		std::optional<SDL_Rect> insertSkyline(int width, int height);
+		std::optional<SDL_Rect> insertMaxRects(int width, int height);
+
+		void removeBinaryTree(int node);
+		// Adds the freed rect to the free rects of MaxRects and Skyline, joined with the free rects it touches.
+		void addFreeRect(const SDL_Rect& rect);
+		// Recomputes the free rects, and the skyline of Skyline, from the used rects.
+		void rebuildFreeSpace();
+
+		// Returns the top of the image placed at the segment, or std::nullopt if it does not fit.
+		std::optional<int> skylineFit(size_t index, int width, int height) const;
+		void skylineAdd(size_t index, const SDL_Rect& rect);
+
+		void maxRectsPlace(const SDL_Rect& rect);
+
+		int width_ = 2048;
+		int height_ = 2048;
+		AtlasPacking packing_ = AtlasPacking::BinaryTree;
+		int64_t usedArea_ = 0;
+		size_t size_ = 0;
+
+		std::vector<Entry> entries_;
+		std::vector<uint32_t> freeEntries_;
+		std::vector<Node> nodes_;
+		std::vector<int> freeNodePairs_;
+		std::vector<int> stack_;
+		std::vector<SkylineSegment> skyline_;
+		// Free space of MaxRects, and space freed below the skyline of Skyline.
+		std::vector<SDL_Rect> freeRects_;
+		std::vector<SDL_Rect> joinedRects_;
+		// Set when space is freed, as the free rects may then miss some of it until they are rebuilt.
+		bool freeSpaceFragmented_ = false;
 	};
 
 }
@@ -0,0 +1,180 @@
+#include "meshoptimize.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace sdl {
+
+	namespace {
+
+		constexpr int CacheSize = 32;
+		constexpr uint32_t NoTriangle = std::numeric_limits<uint32_t>::max();
+
+		// Scoring from https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+		float vertexScore(int cachePosition, uint32_t remainingTriangles) {
+			if (remainingTriangles == 0) {
+				return -1.f;
+			}
+			float score = 0.f;
+			if (cachePosition >= 0) {
+				if (cachePosition < 3) {
+					// The vertices of the last triangle get a fixed score, to not favor any of them.
+					score = 0.75f;
+				} else {
+					score = std::pow(1.f - static_cast<float>(cachePosition - 3) / (CacheSize - 3), 1.5f);
+				}
+			}
+			return score + 2.f / std::sqrt(static_cast<float>(remainingTriangles));
+		}
+
+	}
+
+	void optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount) {
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount < 2) {
+			return;
+		}
+
+		// Triangles using each vertex, vertex v owns adjacency[offsets[v] .. offsets[v] + remaining[v]).
+		std::vector<uint32_t> remaining(vertexCount);
+		for (size_t i = 0; i < triangleCount * 3; ++i) {
+			++remaining[indices[i]];
+		}
+		std::vector<uint32_t> offsets(vertexCount + 1);
+		for (size_t v = 0; v < vertexCount; ++v) {
+			offsets[v + 1] = offsets[v] + remaining[v];
+		}
+		std::vector<uint32_t> adjacency(triangleCount * 3);
+		{
+			std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+			for (size_t i = 0; i < triangleCount * 3; ++i) {
+				adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+		}
+
+		std::vector<int> cachePositions(vertexCount, -1);
+		std::vector<float> vertexScores(vertexCount);
+		for (size_t v = 0; v < vertexCount; ++v) {
+			vertexScores[v] = vertexScore(-1, remaining[v]);
+		}
+
+		std::vector<float> triangleScores(triangleCount);
+		std::vector<uint8_t> emitted(triangleCount);
+		uint32_t best = 0;
+		for (uint32_t t = 0; t < triangleCount; ++t) {
+			triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+			if (triangleScores[t] > triangleScores[best]) {
+				best = t;
+			}
+		}
+
+		std::vector<uint32_t> result;
+		result.reserve(triangleCount * 3);
+		std::array<uint32_t, CacheSize + 3> cache{};
+		std::array<uint32_t, CacheSize + 3> newCache{};
+		size_t cacheCount = 0;
+		size_t nextCandidate = 0;
+
+		while (best != NoTriangle) {
+			emitted[best] = 1;
+			const std::array<uint32_t, 3> triangle{indices[best * 3], indices[best * 3 + 1], indices[best * 3 + 2]};
+
+			size_t newCount = 0;
+			for (uint32_t v : triangle) {
+				result.push_back(v);
+
+				// Remove the triangle from the vertex adjacency.
+				auto first = adjacency.begin() + offsets[v];
+				auto last = first + remaining[v];
+				auto it = std::find(first, last, best);
+				if (it != last) {
+					std::iter_swap(it, last - 1);
+					--remaining[v];
+				}
+				if (std::find(newCache.begin(), newCache.begin() + newCount, v) == newCache.begin() + newCount) {
+					newCache[newCount++] = v;
+				}
+			}
+			for (size_t i = 0; i < cacheCount; ++i) {
+				uint32_t v = cache[i];
+				if (std::find(triangle.begin(), triangle.end(), v) == triangle.end()) {
+					newCache[newCount++] = v;
+				}
+			}
+			std::copy(newCache.begin(), newCache.begin() + newCount, cache.begin());
+			cacheCount = newCount;
+
+			// Update the scores of the cached and evicted vertices and their triangles.
+			for (size_t i = 0; i < cacheCount; ++i) {
+				uint32_t v = cache[i];
+				cachePositions[v] = i < CacheSize ? static_cast<int>(i) : -1;
+				vertexScores[v] = vertexScore(cachePositions[v], remaining[v]);
+			}
+
+			best = NoTriangle;
+			float bestScore = -1.f;
+			for (size_t i = 0; i < cacheCount; ++i) {
+				uint32_t v = cache[i];
+				for (uint32_t j = offsets[v]; j < offsets[v] + remaining[v]; ++j) {
+					uint32_t t = adjacency[j];
+					float score = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+					triangleScores[t] = score;
+					if (score > bestScore) {
+						bestScore = score;
+						best = t;
+					}
+				}
+			}
+			cacheCount = std::min<size_t>(cacheCount, CacheSize);
+
+			if (best == NoTriangle) {
+				while (nextCandidate < triangleCount && emitted[nextCandidate]) {
+					++nextCandidate;
+				}
+				if (nextCandidate < triangleCount) {
+					best = static_cast<uint32_t>(nextCandidate);
+				}
+			}
+		}
+
+		std::copy(result.begin(), result.end(), indices.begin());
+	}
+
+	std::vector<uint32_t> optimizeVertexFetch(std::span<uint32_t> indices, size_t vertexCount) {
+		constexpr uint32_t Unused = std::numeric_limits<uint32_t>::max();
+		std::vector<uint32_t> newIndex(vertexCount, Unused);
+		std::vector<uint32_t> oldIndex;
+		oldIndex.reserve(vertexCount);
+
+		for (auto& index : indices) {
+			if (newIndex[index] == Unused) {
+				newIndex[index] = static_cast<uint32_t>(oldIndex.size());
+				oldIndex.push_back(index);
+			}
+			index = newIndex[index];
+		}
+		return oldIndex;
+	}
+
+	float averageCacheMissRatio(std::span<const uint32_t> indices, size_t vertexCount, size_t cacheSize) {
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0) {
+			return 0.f;
+		}
+		// Time stamp when each vertex entered the FIFO cache.
+		std::vector<size_t> entered(vertexCount, 0);
+		size_t time = cacheSize + 1;
+		size_t misses = 0;
+		for (size_t i = 0; i < triangleCount * 3; ++i) {
+			uint32_t v = indices[i];
+			if (time - entered[v] > cacheSize) {
+				entered[v] = time++;
+				++misses;
+			}
+		}
+		return static_cast<float>(misses) / static_cast<float>(triangleCount);
+	}
+
+}
@@ -0,0 +1,29 @@
+#ifndef CPPSDL3_SDL_MESHOPTIMIZE_H
+#define CPPSDL3_SDL_MESHOPTIMIZE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace sdl {
+
+	/// @brief Reorders the triangles of a triangle list for the post-transform vertex cache, using
+	/// Tom Forsyth's linear-speed vertex cache optimization. Trailing indices not forming a triangle are kept.
+	/// @param indices Triangle list, every index must be less than vertexCount
+	/// @param vertexCount Number of vertices referenced by the indices
+	void optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount);
+
+	/// @brief Renumbers the vertices in the order they are first used by the indices, which improves
+	/// vertex fetch locality. Unused vertices get no new number.
+	/// @return The old vertex index for each new vertex index
+	[[nodiscard]]
+	std::vector<uint32_t> optimizeVertexFetch(std::span<uint32_t> indices, size_t vertexCount);
+
+	/// @brief Average number of vertex shader invocations per triangle, simulating a FIFO cache.
+	[[nodiscard]]
+	float averageCacheMissRatio(std::span<const uint32_t> indices, size_t vertexCount, size_t cacheSize = 16);
+
+}
+
+#endif
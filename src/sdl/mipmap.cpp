@@ -0,0 +1,79 @@
+#include "mipmap.h"
+#include "sdlexception.h"
+
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CPPSDL3_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace sdl {
+
+	void downsampleRgba32(const std::byte* source, int width, int height, int pitch, std::byte* destination, int destinationPitch) noexcept {
+		const int destinationWidth = std::max(width / 2, 1);
+		const int destinationHeight = std::max(height / 2, 1);
+
+		for (int y = 0; y < destinationHeight; ++y) {
+			auto row0 = reinterpret_cast<const uint8_t*>(source + std::min(2 * y, height - 1) * pitch);
+			auto row1 = reinterpret_cast<const uint8_t*>(source + std::min(2 * y + 1, height - 1) * pitch);
+			auto out = reinterpret_cast<uint8_t*>(destination + y * destinationPitch);
+
+			int x = 0;
+#ifdef CPPSDL3_SSE2
+			// Two destination pixels, i.e. four source pixels per row, per iteration.
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i rounding = _mm_set1_epi16(2);
+			for (; 2 * x + 3 < width && x + 1 < destinationWidth; x += 2) {
+				__m128i top = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 8 * x));
+				__m128i bottom = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 8 * x));
+				__m128i low = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+				__m128i high = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+				low = _mm_add_epi16(low, _mm_srli_si128(low, 8));
+				high = _mm_add_epi16(high, _mm_srli_si128(high, 8));
+				__m128i sum = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(low, high), rounding), 2);
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(out + 4 * x), _mm_packus_epi16(sum, zero));
+			}
+#endif
+			for (; x < destinationWidth; ++x) {
+				const int x0 = 4 * std::min(2 * x, width - 1);
+				const int x1 = 4 * std::min(2 * x + 1, width - 1);
+				for (int channel = 0; channel < 4; ++channel) {
+					const int sum = row0[x0 + channel] + row0[x1 + channel] + row1[x0 + channel] + row1[x1 + channel];
+					out[4 * x + channel] = static_cast<uint8_t>((sum + 2) / 4);
+				}
+			}
+		}
+	}
+
+	std::vector<SdlSurface> generateMipChain(SDL_Surface* surface) {
+		SdlSurface converted;
+		if (surface->format != SDL_PIXELFORMAT_RGBA32) {
+			converted.reset(SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGBA32));
+			if (!converted) {
+				throw sdl::SdlException{"Failed to convert surface to RGBA32"};
+			}
+			surface = converted.get();
+		}
+
+		const auto levelCount = mipLevelCount(surface->w, surface->h);
+		std::vector<SdlSurface> levels;
+		levels.reserve(levelCount - 1);
+		const SDL_Surface* previous = surface;
+		for (Uint32 level = 1; level < levelCount; ++level) {
+			auto next = SDL_CreateSurface(
+				static_cast<int>(mipLevelSize(surface->w, level)),
+				static_cast<int>(mipLevelSize(surface->h, level)),
+				SDL_PIXELFORMAT_RGBA32);
+			if (!next) {
+				throw sdl::SdlException{"Failed to create mip level {}", level};
+			}
+			levels.push_back(createSdlSurface(next));
+			downsampleRgba32(static_cast<const std::byte*>(previous->pixels), previous->w, previous->h, previous->pitch,
+				static_cast<std::byte*>(next->pixels), next->pitch);
+			previous = next;
+		}
+		return levels;
+	}
+
+}
@@ -0,0 +1,44 @@
+#ifndef CPPSDL3_SDL_MIPMAP_H
+#define CPPSDL3_SDL_MIPMAP_H
+
+#include "util.h"
+
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_surface.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <vector>
+
+namespace sdl {
+
+	/// @brief Number of levels in a full mip chain, down to 1x1.
+	constexpr Uint32 mipLevelCount(Uint32 width, Uint32 height) noexcept {
+		return std::max<Uint32>(std::bit_width(std::max(width, height)), 1);
+	}
+
+	/// @brief Size of the mip level, never smaller than one pixel.
+	constexpr Uint32 mipLevelSize(Uint32 size, Uint32 level) noexcept {
+		return std::max<Uint32>(size >> level, 1);
+	}
+
+	/// @brief Halves RGBA32 pixels with a 2x2 box filter, rounding to nearest. Uses SSE2 when available.
+	/// The size is halved rounding down, like the GPU mip level sizes, so an odd last row or column is not
+	/// sampled. A dimension of one pixel is kept and that pixel is averaged with itself.
+	/// @param source First source pixel
+	/// @param width Source width
+	/// @param height Source height
+	/// @param pitch Bytes between two source rows
+	/// @param destination First destination pixel, of size mipLevelSize(width, 1) x mipLevelSize(height, 1)
+	/// @param destinationPitch Bytes between two destination rows
+	void downsampleRgba32(const std::byte* source, int width, int height, int pitch, std::byte* destination, int destinationPitch) noexcept;
+
+	/// @brief Generates mip levels 1 to mipLevelCount - 1 of the surface on the CPU as RGBA32 surfaces.
+	/// The surface is converted to RGBA32 if needed.
+	[[nodiscard]]
+	std::vector<SdlSurface> generateMipChain(SDL_Surface* surface);
+
+}
+
+#endif
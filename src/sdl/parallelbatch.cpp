@@ -0,0 +1,67 @@
+#include "parallelbatch.h"
+
+namespace sdl {
+
+	ShardWorkers::ShardWorkers(size_t workerCount) {
+		threads_.reserve(workerCount);
+		for (size_t i = 0; i < workerCount; ++i) {
+			threads_.emplace_back([this, i](std::stop_token stopToken) {
+				work(stopToken, i + 1);
+			});
+		}
+	}
+
+	ShardWorkers::~ShardWorkers() {
+		// Requests stop on all threads before joining any of them.
+		for (auto& thread : threads_) {
+			thread.request_stop();
+		}
+		threads_.clear();
+	}
+
+	void ShardWorkers::run(Task task, void* context) {
+		if (!threads_.empty()) {
+			{
+				std::lock_guard lock{mutex_};
+				task_ = task;
+				context_ = context;
+				pending_ = threads_.size();
+				++generation_;
+			}
+			wake_.notify_all();
+		}
+
+		task(context, 0);
+
+		std::unique_lock lock{mutex_};
+		done_.wait(lock, [this]() {
+			return pending_ == 0;
+		});
+	}
+
+	void ShardWorkers::work(std::stop_token stopToken, size_t index) {
+		size_t generation = 0;
+		while (true) {
+			Task task = nullptr;
+			void* context = nullptr;
+			{
+				std::unique_lock lock{mutex_};
+				if (!wake_.wait(lock, stopToken, [&]() { return generation_ != generation; })) {
+					return;
+				}
+				generation = generation_;
+				task = task_;
+				context = context_;
+			}
+
+			task(context, index);
+
+			{
+				std::lock_guard lock{mutex_};
+				--pending_;
+			}
+			done_.notify_one();
+		}
+	}
+
+}
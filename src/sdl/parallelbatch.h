@@ -0,0 +1,134 @@
+#ifndef CPPSDL3_SDL_PARALLELBATCH_H
+#define CPPSDL3_SDL_PARALLELBATCH_H
+
+#include "batch.h"
+
+#include <algorithm>
+#include <concepts>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sdl {
+
+	/// @brief Persistent worker threads running one task per thread and call, used by ParallelBatch so
+	/// that recording a frame does not create threads.
+	class ShardWorkers {
+	public:
+		using Task = void (*)(void* context, size_t index);
+
+		/// @brief Starts the worker threads, which sleep until run() is called.
+		explicit ShardWorkers(size_t workerCount);
+
+		/// @brief Stops and joins the worker threads.
+		~ShardWorkers();
+
+		ShardWorkers(const ShardWorkers&) = delete;
+		ShardWorkers& operator=(const ShardWorkers&) = delete;
+
+		size_t getWorkerCount() const noexcept {
+			return threads_.size();
+		}
+
+		/// @brief Calls task(context, 0) on the calling thread and task(context, i) on worker i - 1, for
+		/// i in [1, getWorkerCount()]. Returns when all calls are done. The task must not throw.
+		void run(Task task, void* context);
+
+	private:
+		void work(std::stop_token stopToken, size_t index);
+
+		std::mutex mutex_;
+		std::condition_variable_any wake_;
+		std::condition_variable done_;
+		Task task_ = nullptr;
+		void* context_ = nullptr;
+		size_t generation_ = 0;
+		size_t pending_ = 0;
+		// Last member, the threads are stopped and joined before the members they use are destroyed.
+		std::vector<std::jthread> threads_;
+	};
+
+	/// @brief A set of Batch shards which can be filled by separate threads without locking.
+	/// Merging the shards in shard order gives the same result as filling one batch in order.
+	/// Owns one worker thread per shard except the first, which is reused by every call to record().
+	template <VertexType Vertex, IndexType Index = uint32_t>
+	class ParallelBatch {
+	public:
+		explicit ParallelBatch(size_t shardCount = std::max(std::thread::hardware_concurrency(), 1u))
+			: shards_(std::max<size_t>(shardCount, 1))
+			, workers_{shards_.size() - 1} {
+		}
+
+		size_t getShardCount() const noexcept {
+			return shards_.size();
+		}
+
+		Batch<Vertex, Index>& shard(size_t index) {
+			return shards_[index];
+		}
+
+		const Batch<Vertex, Index>& shard(size_t index) const {
+			return shards_[index];
+		}
+
+		/// @brief Splits [0, count) into one contiguous range per shard and calls func(shard, begin, end)
+		/// for each range on the shard's worker thread. The first range runs on the calling thread. Returns
+		/// when all ranges are done, rethrowing the first exception thrown by func.
+		template <std::invocable<Batch<Vertex, Index>&, size_t, size_t> Func>
+		void record(size_t count, Func&& func) {
+			const size_t shardCount = shards_.size();
+			exceptions_.assign(shardCount, nullptr);
+
+			auto run = [&](size_t shardIndex) {
+				size_t begin = count * shardIndex / shardCount;
+				size_t end = count * (shardIndex + 1) / shardCount;
+				try {
+					func(shards_[shardIndex], begin, end);
+				} catch (...) {
+					exceptions_[shardIndex] = std::current_exception();
+				}
+			};
+
+			workers_.run([](void* context, size_t shardIndex) {
+				(*static_cast<decltype(run)*>(context))(shardIndex);
+			}, &run);
+
+			for (const auto& exception : exceptions_) {
+				if (exception) {
+					std::rethrow_exception(exception);
+				}
+			}
+		}
+
+		/// @brief Appends all shards, in shard order, to the batch.
+		void mergeInto(Batch<Vertex, Index>& batch) const {
+			size_t vertexCount = batch.vertices().size();
+			size_t indexCount = batch.indices().size();
+			for (const auto& shard : shards_) {
+				vertexCount += shard.vertices().size();
+				indexCount += shard.indices().size();
+			}
+			batch.reserve(vertexCount, indexCount);
+
+			for (const auto& shard : shards_) {
+				batch.append(shard);
+			}
+		}
+
+		void clear() {
+			for (auto& shard : shards_) {
+				shard.clear();
+			}
+		}
+
+	private:
+		std::vector<Batch<Vertex, Index>> shards_;
+		std::vector<std::exception_ptr> exceptions_;
+		ShardWorkers workers_;
+	};
+
+}
+
+#endif
@@ -0,0 +1,230 @@
+#include "pipelinecache.h"
+
+#include <spdlog/spdlog.h>
+
+#include <cstring>
+#include <optional>
+#include <type_traits>
+
+namespace sdl {
+
+	namespace {
+
+		class KeyWriter {
+		public:
+			explicit KeyWriter(std::string& key)
+				: key_{key} {
+			}
+
+			template <typename T>
+				requires std::is_scalar_v<T>
+			KeyWriter& operator<<(T value) {
+				char bytes[sizeof(T)];
+				std::memcpy(bytes, &value, sizeof(T));
+				key_.append(bytes, sizeof(T));
+				return *this;
+			}
+
+			KeyWriter& operator<<(const SDL_GPUStencilOpState& state) {
+				return *this << state.fail_op << state.pass_op << state.depth_fail_op << state.compare_op;
+			}
+
+			KeyWriter& operator<<(const SDL_GPUVertexBufferDescription& description) {
+				return *this << description.slot << description.pitch << description.input_rate << description.instance_step_rate;
+			}
+
+			KeyWriter& operator<<(const SDL_GPUVertexAttribute& attribute) {
+				return *this << attribute.location << attribute.buffer_slot << attribute.format << attribute.offset;
+			}
+
+			KeyWriter& operator<<(const SDL_GPUColorTargetDescription& description) {
+				const auto& blend = description.blend_state;
+				return *this << description.format
+					<< blend.src_color_blendfactor << blend.dst_color_blendfactor << blend.color_blend_op
+					<< blend.src_alpha_blendfactor << blend.dst_alpha_blendfactor << blend.alpha_blend_op
+					<< blend.color_write_mask << blend.enable_blend << blend.enable_color_write_mask;
+			}
+
+			template <typename T>
+			KeyWriter& operator<<(std::span<const T> values) {
+				*this << values.size();
+				for (const auto& value : values) {
+					*this << value;
+				}
+				return *this;
+			}
+
+		private:
+			std::string& key_;
+		};
+
+		// Writes into the string, which keeps its capacity, so a reused string does not allocate.
+		void writeKey(const SDL_GPUGraphicsPipelineCreateInfo& createInfo, std::string& key) {
+			const auto& vertexInput = createInfo.vertex_input_state;
+			const auto& rasterizer = createInfo.rasterizer_state;
+			const auto& multisample = createInfo.multisample_state;
+			const auto& depthStencil = createInfo.depth_stencil_state;
+			const auto& target = createInfo.target_info;
+
+			key.clear();
+			KeyWriter writer{key};
+			writer << createInfo.vertex_shader << createInfo.fragment_shader
+				<< std::span{vertexInput.vertex_buffer_descriptions, vertexInput.num_vertex_buffers}
+				<< std::span{vertexInput.vertex_attributes, vertexInput.num_vertex_attributes}
+				<< createInfo.primitive_type
+				<< rasterizer.fill_mode << rasterizer.cull_mode << rasterizer.front_face
+				<< rasterizer.depth_bias_constant_factor << rasterizer.depth_bias_clamp << rasterizer.depth_bias_slope_factor
+				<< rasterizer.enable_depth_bias << rasterizer.enable_depth_clip
+				<< multisample.sample_count << multisample.sample_mask << multisample.enable_mask << multisample.enable_alpha_to_coverage
+				<< depthStencil.compare_op << depthStencil.back_stencil_state << depthStencil.front_stencil_state
+				<< depthStencil.compare_mask << depthStencil.write_mask
+				<< depthStencil.enable_depth_test << depthStencil.enable_depth_write << depthStencil.enable_stencil_test
+				<< std::span{target.color_target_descriptions, target.num_color_targets}
+				<< target.depth_stencil_format << target.has_depth_stencil_target;
+		}
+
+		// Owns copies of the arrays the create info points to.
+		struct CreateInfoCopy {
+			explicit CreateInfoCopy(const SDL_GPUGraphicsPipelineCreateInfo& info)
+				: createInfo{info}
+				, vertexBufferDescriptions(info.vertex_input_state.vertex_buffer_descriptions,
+					info.vertex_input_state.vertex_buffer_descriptions + info.vertex_input_state.num_vertex_buffers)
+				, vertexAttributes(info.vertex_input_state.vertex_attributes,
+					info.vertex_input_state.vertex_attributes + info.vertex_input_state.num_vertex_attributes)
+				, colorTargetDescriptions(info.target_info.color_target_descriptions,
+					info.target_info.color_target_descriptions + info.target_info.num_color_targets) {
+
+				createInfo.vertex_input_state.vertex_buffer_descriptions = vertexBufferDescriptions.data();
+				createInfo.vertex_input_state.vertex_attributes = vertexAttributes.data();
+				createInfo.target_info.color_target_descriptions = colorTargetDescriptions.data();
+			}
+
+			CreateInfoCopy(const CreateInfoCopy&) = delete;
+			CreateInfoCopy& operator=(const CreateInfoCopy&) = delete;
+
+			SDL_GPUGraphicsPipelineCreateInfo createInfo;
+			std::vector<SDL_GPUVertexBufferDescription> vertexBufferDescriptions;
+			std::vector<SDL_GPUVertexAttribute> vertexAttributes;
+			std::vector<SDL_GPUColorTargetDescription> colorTargetDescriptions;
+		};
+
+	}
+
+	PipelineCache::PipelineCache(SDL_GPUDevice* gpuDevice)
+		: gpuDevice_{gpuDevice} {
+	}
+
+	PipelineCache::~PipelineCache() {
+		waitForWarmUp();
+	}
+
+	SDL_GPUGraphicsPipeline* PipelineCache::get(const SDL_GPUGraphicsPipelineCreateInfo& createInfo) {
+		// Reused by the calls on this thread, so a cache hit does not allocate.
+		thread_local std::string pipelineKey;
+		writeKey(createInfo, pipelineKey);
+
+		PipelineFuture future;
+		std::optional<std::promise<SDL_GPUGraphicsPipeline*>> promise;
+		{
+			std::lock_guard lock{mutex_};
+			if (auto it = pipelines_.find(pipelineKey); it != pipelines_.end()) {
+				future = it->second;
+			} else {
+				promise.emplace();
+				pipelines_.emplace(pipelineKey, promise->get_future().share());
+			}
+		}
+		if (future.valid()) {
+			return future.get();
+		}
+		return create(pipelineKey, createInfo, *promise);
+	}
+
+	void PipelineCache::warmUp(std::span<const SDL_GPUGraphicsPipelineCreateInfo> createInfos) {
+		struct Job {
+			std::string key;
+			std::unique_ptr<CreateInfoCopy> createInfo;
+			std::promise<SDL_GPUGraphicsPipeline*> promise;
+		};
+
+		std::vector<Job> jobs;
+		{
+			std::lock_guard lock{mutex_};
+			for (const auto& createInfo : createInfos) {
+				auto pipelineKey = key(createInfo);
+				if (pipelines_.contains(pipelineKey)) {
+					continue;
+				}
+				Job job{
+					.key = pipelineKey,
+					.createInfo = std::make_unique<CreateInfoCopy>(createInfo)
+				};
+				pipelines_.emplace(std::move(pipelineKey), job.promise.get_future().share());
+				jobs.push_back(std::move(job));
+			}
+		}
+		if (jobs.empty()) {
+			return;
+		}
+
+		std::lock_guard lock{mutex_};
+		warmUpThreads_.emplace_back([this, jobs = std::move(jobs)]() mutable {
+			for (auto& job : jobs) {
+				try {
+					[[maybe_unused]] auto pipeline = create(job.key, job.createInfo->createInfo, job.promise);
+				} catch (const std::exception& e) {
+					spdlog::warn("[PipelineCache] Failed to warm up pipeline: {}", e.what());
+				}
+			}
+		});
+	}
+
+	void PipelineCache::waitForWarmUp() {
+		std::vector<std::jthread> threads;
+		{
+			std::lock_guard lock{mutex_};
+			threads.swap(warmUpThreads_);
+		}
+		// Joined when destroyed.
+	}
+
+	void PipelineCache::clear() {
+		waitForWarmUp();
+		std::lock_guard lock{mutex_};
+		pipelines_.clear();
+		owned_.clear();
+	}
+
+	size_t PipelineCache::getSize() const {
+		std::lock_guard lock{mutex_};
+		return pipelines_.size();
+	}
+
+	std::string PipelineCache::key(const SDL_GPUGraphicsPipelineCreateInfo& createInfo) {
+		std::string key;
+		writeKey(createInfo, key);
+		return key;
+	}
+
+	SDL_GPUGraphicsPipeline* PipelineCache::create(const std::string& key, const SDL_GPUGraphicsPipelineCreateInfo& createInfo, std::promise<SDL_GPUGraphicsPipeline*>& promise) {
+		try {
+			auto pipeline = createGpuGraphicsPipeline(gpuDevice_, createInfo);
+			SDL_GPUGraphicsPipeline* result = pipeline.get();
+			{
+				std::lock_guard lock{mutex_};
+				owned_.push_back(std::move(pipeline));
+			}
+			promise.set_value(result);
+			return result;
+		} catch (...) {
+			// Removed, so the next get() tries again.
+			{
+				std::lock_guard lock{mutex_};
+				pipelines_.erase(key);
+			}
+			promise.set_exception(std::current_exception());
+			throw;
+		}
+	}
+
+}
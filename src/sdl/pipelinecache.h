@@ -0,0 +1,70 @@
+#ifndef CPPSDL3_SDL_PIPELINECACHE_H
+#define CPPSDL3_SDL_PIPELINECACHE_H
+
+#include "gpu.h"
+
+#include <SDL3/SDL_gpu.h>
+
+#include <future>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace sdl {
+
+	/// @brief Shares graphics pipelines between users with equal create infos.
+	/// The key is the full create info, including the arrays it points to, so two create infos built
+	/// separately with the same content give the same pipeline. Shaders are part of the key by handle.
+	class PipelineCache {
+	public:
+		explicit PipelineCache(SDL_GPUDevice* gpuDevice);
+
+		/// @brief Waits for the warm-up to finish and releases all pipelines.
+		~PipelineCache();
+
+		PipelineCache(const PipelineCache&) = delete;
+		PipelineCache& operator=(const PipelineCache&) = delete;
+
+		/// @brief Returns the pipeline for the create info, created on first use. Waits if the pipeline is
+		/// being created by warmUp(). Is thread safe. A cache hit still serializes the create info and locks,
+		/// so look the pipeline up once, e.g. in preLoop(), and keep the pointer instead of calling get() per draw.
+		/// @return Pipeline owned by the cache, valid until the cache is cleared or destroyed
+		[[nodiscard]]
+		SDL_GPUGraphicsPipeline* get(const SDL_GPUGraphicsPipelineCreateInfo& createInfo);
+
+		/// @brief Creates the pipelines on a worker thread, e.g. during startup, so get() finds them ready.
+		/// The create infos are copied, the shaders must stay alive until the warm-up is done.
+		void warmUp(std::span<const SDL_GPUGraphicsPipelineCreateInfo> createInfos);
+
+		/// @brief Blocks until all started warm-ups are done.
+		void waitForWarmUp();
+
+		/// @brief Releases all pipelines, after waiting for the warm-up.
+		void clear();
+
+		/// @brief Number of pipelines, including those being created.
+		[[nodiscard]]
+		size_t getSize() const;
+
+		/// @brief Serialized content of the create info, used as key. Padding fields and props are ignored.
+		[[nodiscard]]
+		static std::string key(const SDL_GPUGraphicsPipelineCreateInfo& createInfo);
+
+	private:
+		using PipelineFuture = std::shared_future<SDL_GPUGraphicsPipeline*>;
+
+		SDL_GPUGraphicsPipeline* create(const std::string& key, const SDL_GPUGraphicsPipelineCreateInfo& createInfo, std::promise<SDL_GPUGraphicsPipeline*>& promise);
+
+		SDL_GPUDevice* gpuDevice_ = nullptr;
+		mutable std::mutex mutex_;
+		std::unordered_map<std::string, PipelineFuture> pipelines_;
+		std::vector<GpuGraphicsPipeline> owned_;
+		std::vector<std::jthread> warmUpThreads_;
+	};
+
+}
+
+#endif
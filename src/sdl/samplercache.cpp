@@ -0,0 +1,58 @@
+#include "samplercache.h"
+
+#include <bit>
+
+namespace sdl {
+
+	SamplerCache::SamplerCache(SDL_GPUDevice* gpuDevice)
+		: gpuDevice_{gpuDevice} {
+	}
+
+	SDL_GPUSampler* SamplerCache::get(const SDL_GPUSamplerCreateInfo& createInfo) {
+		auto key = makeKey(createInfo);
+
+		std::lock_guard lock{mutex_};
+		auto it = samplers_.find(key);
+		if (it == samplers_.end()) {
+			it = samplers_.emplace(key, createGpuSampler(gpuDevice_, createInfo)).first;
+		}
+		return it->second.get();
+	}
+
+	void SamplerCache::clear() {
+		std::lock_guard lock{mutex_};
+		samplers_.clear();
+	}
+
+	size_t SamplerCache::getSize() const {
+		std::lock_guard lock{mutex_};
+		return samplers_.size();
+	}
+
+	size_t SamplerCache::KeyHash::operator()(const Key& key) const noexcept {
+		size_t hash = 0;
+		for (auto value : key) {
+			hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		}
+		return hash;
+	}
+
+	SamplerCache::Key SamplerCache::makeKey(const SDL_GPUSamplerCreateInfo& createInfo) noexcept {
+		return {
+			static_cast<Uint32>(createInfo.min_filter),
+			static_cast<Uint32>(createInfo.mag_filter),
+			static_cast<Uint32>(createInfo.mipmap_mode),
+			static_cast<Uint32>(createInfo.address_mode_u),
+			static_cast<Uint32>(createInfo.address_mode_v),
+			static_cast<Uint32>(createInfo.address_mode_w),
+			std::bit_cast<Uint32>(createInfo.mip_lod_bias),
+			std::bit_cast<Uint32>(createInfo.max_anisotropy),
+			static_cast<Uint32>(createInfo.compare_op),
+			std::bit_cast<Uint32>(createInfo.min_lod),
+			std::bit_cast<Uint32>(createInfo.max_lod),
+			static_cast<Uint32>(createInfo.enable_anisotropy),
+			static_cast<Uint32>(createInfo.enable_compare)
+		};
+	}
+
+}
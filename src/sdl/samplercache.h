@@ -0,0 +1,56 @@
+#ifndef CPPSDL3_SDL_SAMPLERCACHE_H
+#define CPPSDL3_SDL_SAMPLERCACHE_H
+
+#include "gpu.h"
+#include "gpuutil.h"
+
+#include <SDL3/SDL_gpu.h>
+
+#include <array>
+#include <mutex>
+#include <unordered_map>
+
+namespace sdl {
+
+	/// @brief Creates each distinct sampler once per device.
+	/// The returned samplers are owned by the cache and keep their address until the cache is cleared, so
+	/// equal sampler state can be compared by pointer, e.g. when sorting draw commands.
+	class SamplerCache {
+	public:
+		explicit SamplerCache(SDL_GPUDevice* gpuDevice);
+
+		SamplerCache(const SamplerCache&) = delete;
+		SamplerCache& operator=(const SamplerCache&) = delete;
+
+		/// @brief Returns the sampler for the create info, created on first use. Props are ignored. Is thread safe.
+		[[nodiscard]]
+		SDL_GPUSampler* get(const SDL_GPUSamplerCreateInfo& createInfo);
+
+		[[nodiscard]]
+		SDL_GPUSampler* get(SamplerPreset preset) {
+			return get(samplerCreateInfo(preset));
+		}
+
+		/// @brief Releases all samplers, none of them may be in use by the caller.
+		void clear();
+
+		[[nodiscard]]
+		size_t getSize() const;
+
+	private:
+		using Key = std::array<Uint32, 13>;
+
+		struct KeyHash {
+			size_t operator()(const Key& key) const noexcept;
+		};
+
+		static Key makeKey(const SDL_GPUSamplerCreateInfo& createInfo) noexcept;
+
+		SDL_GPUDevice* gpuDevice_ = nullptr;
+		mutable std::mutex mutex_;
+		std::unordered_map<Key, GpuSampler, KeyHash> samplers_;
+	};
+
+}
+
+#endif
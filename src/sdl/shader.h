@@ -5,48 +5,50 @@
 #include "shader.vs.h"
 
 #include <sdl/gpu.h>
+#include <sdl/vertexlayout.h>
+#include <sdl/color.h>
 #include <glm/glm.hpp>
 
 #include <array>
+#include <cstddef>
 
 namespace sdl {
 
-	// Does not need to be std140 because we define the layout in Shader struct.
+	// Does not need to be std140 because the layout is derived from the Layout type list.
 	struct Vertex {
 		glm::vec3 position;
 		glm::vec2 tex;
 		glm::vec4 color;
+
+		// position maps to TEXCOORD0, tex to TEXCOORD1 and color to TEXCOORD2.
+		using Layout = VertexLayout<glm::vec3, glm::vec2, glm::vec4>;
 	};
 	static_assert(VertexType<Vertex>, "Vertex must satisfy VertexType");
+	static_assert(Vertex::Layout::Offsets == std::array<Uint32, 3>{offsetof(Vertex, position), offsetof(Vertex, tex), offsetof(Vertex, color)});
+	static_assert(Vertex::Layout::Stride == sizeof(Vertex));
+
+	/// @brief Compact 2D vertex, 16 bytes instead of 36. Uses the same shader as Vertex, the input
+	/// assembler expands the position with z = 0 and unpacks the half floats and the color bytes.
+	struct SpriteVertex {
+		glm::vec2 position;
+		Half2 tex;
+		Color color;
+
+		using Layout = VertexLayout<glm::vec2, Half2, Color>;
+	};
+	static_assert(VertexType<SpriteVertex>, "SpriteVertex must satisfy VertexType");
+	static_assert(SpriteVertex::Layout::Offsets == std::array<Uint32, 3>{offsetof(SpriteVertex, position), offsetof(SpriteVertex, tex), offsetof(SpriteVertex, color)});
+	static_assert(SpriteVertex::Layout::Stride == sizeof(SpriteVertex));
 
 	struct Shader {
 		void load(SDL_GPUDevice* gpuDevice);
 		
 		static void uploadProjectionMatrix(SDL_GPUCommandBuffer* commandBuffer, const glm::mat4& projection);
 
-		static constexpr std::array<SDL_GPUVertexAttribute, 3> attributes = {
-			// position maps to TEXCOORD0
-			SDL_GPUVertexAttribute{
-				.location = 0,
-				.buffer_slot = 0,
-				.format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3,
-				.offset = offsetof(Vertex, position)
-			},
-			// tex maps to TEXCOORD1
-			SDL_GPUVertexAttribute{
-					.location = 1,
-					.buffer_slot = 0,
-					.format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2,
-					.offset = offsetof(Vertex, tex)
-			},
-			// color maps to TEXCOORD2
-			SDL_GPUVertexAttribute{
-					.location = 2,
-					.buffer_slot = 0,
-					.format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4,
-					.offset = offsetof(Vertex, color)
-			}
-		};
+		static constexpr auto attributes = Vertex::Layout::attributes();
+
+		/// @brief Attributes for SpriteVertex buffers, used with the same vertex shader.
+		static constexpr auto spriteAttributes = SpriteVertex::Layout::attributes();
 
 		sdl::GpuShader vertexShader;
 		sdl::GpuShader fragmentShader;
@@ -0,0 +1,122 @@
+#include "spriterenderer.h"
+
+#include <array>
+#include <cmath>
+
+namespace sdl {
+
+	namespace {
+
+		// Calls func with the create info, which points to locals of this function.
+		template <typename Func>
+		auto withPipelineCreateInfo(const Shader& shader, SDL_GPUTextureFormat colorFormat, Func&& func) {
+			auto vertexBufferDescription = sdl::vertexBufferDescription<SpriteVertex>();
+
+			SDL_GPUColorTargetDescription colorTargetDescription{
+				.format = colorFormat,
+				.blend_state = SDL_GPUColorTargetBlendState{
+					.src_color_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA,
+					.dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+					.color_blend_op = SDL_GPU_BLENDOP_ADD,
+					.src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA,
+					.dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+					.alpha_blend_op = SDL_GPU_BLENDOP_ADD,
+					.enable_blend = true,
+				}
+			};
+
+			SDL_GPUGraphicsPipelineCreateInfo pipelineInfo{
+				.vertex_shader = shader.vertexShader.get(),
+				.fragment_shader = shader.fragmentShader.get(),
+				.vertex_input_state = SDL_GPUVertexInputState{
+					.vertex_buffer_descriptions = &vertexBufferDescription,
+					.num_vertex_buffers = 1,
+					.vertex_attributes = Shader::spriteAttributes.data(),
+					.num_vertex_attributes = static_cast<Uint32>(Shader::spriteAttributes.size())
+				},
+				.primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
+				.target_info = SDL_GPUGraphicsPipelineTargetInfo{
+					.color_target_descriptions = &colorTargetDescription,
+					.num_color_targets = 1,
+				}
+			};
+			return func(pipelineInfo);
+		}
+
+	}
+
+	glm::vec4 atlasUvRect(const ImageAtlas& atlas, const SDL_Rect& rect) noexcept {
+		const auto width = static_cast<float>(atlas.getWidth());
+		const auto height = static_cast<float>(atlas.getHeight());
+		return {
+			rect.x / width,
+			rect.y / height,
+			(rect.x + rect.w) / width,
+			(rect.y + rect.h) / height
+		};
+	}
+
+	GpuGraphicsPipeline SpriteRenderer::createGraphicsPipeline(SDL_GPUDevice* gpuDevice, const Shader& shader, SDL_GPUTextureFormat colorFormat) {
+		return withPipelineCreateInfo(shader, colorFormat, [&](const SDL_GPUGraphicsPipelineCreateInfo& createInfo) {
+			return createGpuGraphicsPipeline(gpuDevice, createInfo);
+		});
+	}
+
+	SDL_GPUGraphicsPipeline* SpriteRenderer::getGraphicsPipeline(PipelineCache& pipelineCache, const Shader& shader, SDL_GPUTextureFormat colorFormat) {
+		return withPipelineCreateInfo(shader, colorFormat, [&](const SDL_GPUGraphicsPipelineCreateInfo& createInfo) {
+			return pipelineCache.get(createInfo);
+		});
+	}
+
+	void SpriteRenderer::add(const Sprite& sprite) {
+		const glm::vec2 half = sprite.size * 0.5f;
+		glm::vec2 right{half.x, 0.f};
+		glm::vec2 up{0.f, half.y};
+		if (sprite.rotation != 0.f) {
+			const float cos = std::cos(sprite.rotation);
+			const float sin = std::sin(sprite.rotation);
+			right = glm::vec2{cos, sin} * half.x;
+			up = glm::vec2{-sin, cos} * half.y;
+		}
+		const auto& uv = sprite.uvRect;
+
+		batch_.startBatch();
+		batch_.insert({
+			SpriteVertex{sprite.position - right - up, Half2{glm::vec2{uv.x, uv.y}}, sprite.color},
+			SpriteVertex{sprite.position + right - up, Half2{glm::vec2{uv.z, uv.y}}, sprite.color},
+			SpriteVertex{sprite.position + right + up, Half2{glm::vec2{uv.z, uv.w}}, sprite.color},
+			SpriteVertex{sprite.position - right + up, Half2{glm::vec2{uv.x, uv.w}}, sprite.color}
+		});
+		batch_.insertIndices({0, 1, 2, 2, 3, 0});
+	}
+
+	void SpriteRenderer::add(std::span<const Sprite> sprites) {
+		reserve(batch_.vertices().size() / 4 + sprites.size());
+		for (const auto& sprite : sprites) {
+			add(sprite);
+		}
+	}
+
+	void SpriteRenderer::reserve(size_t spriteCount) {
+		batch_.reserve(spriteCount * 4, spriteCount * 6);
+	}
+
+	void SpriteRenderer::clear() {
+		auto state = batch_.getDrawState();
+		batch_.clear();
+		batch_.setDrawState(state);
+		allocation_ = {};
+	}
+
+	void SpriteRenderer::upload(StreamingBuffer& streamingBuffer) {
+		allocation_ = streamingBuffer.push(batch_);
+	}
+
+	void SpriteRenderer::draw(SDL_GPURenderPass* renderPass, const StreamingBuffer& streamingBuffer, const std::optional<SDL_Rect>& renderArea) const {
+		if (batch_.commands().empty()) {
+			return;
+		}
+		batch_.draw(renderPass, streamingBuffer.getBinding(allocation_.vertices), streamingBuffer.getBinding(allocation_.indices), renderArea);
+	}
+
+}
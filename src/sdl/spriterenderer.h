@@ -0,0 +1,78 @@
+#ifndef CPPSDL3_SDL_SPRITERENDERER_H
+#define CPPSDL3_SDL_SPRITERENDERER_H
+
+#include "batch.h"
+#include "color.h"
+#include "gpuutil.h"
+#include "imageatlas.h"
+#include "pipelinecache.h"
+#include "shader.h"
+
+#include <SDL3/SDL_gpu.h>
+#include <glm/glm.hpp>
+
+#include <optional>
+#include <span>
+
+namespace sdl {
+
+	/// @brief Compact per-sprite record, expanded to a quad by SpriteRenderer.
+	struct Sprite {
+		glm::vec2 position{0.f};	// Center of the quad
+		glm::vec2 size{1.f};
+		glm::vec4 uvRect{-1.f};		// (u0, v0, u1, v1), negative means untextured
+		Color color = sdl::color::White;
+		float rotation = 0.f;		// Radians, counter-clockwise around the center
+	};
+
+	/// @brief Returns the normalized uv rect (u0, v0, u1, v1) of a rect inside the atlas.
+	[[nodiscard]]
+	glm::vec4 atlasUvRect(const ImageAtlas& atlas, const SDL_Rect& rect) noexcept;
+
+	/// @brief Draws sprites as 16 byte SpriteVertex quads with 16-bit indices, i.e. 76 bytes per sprite
+	/// instead of 6 full Vertex entries (216 bytes). The data is uploaded once per frame through a StreamingBuffer.
+	class SpriteRenderer {
+	public:
+		using SpriteBatch = Batch<SpriteVertex, uint16_t>;
+
+		/// @brief Creates an alpha blended pipeline for SpriteVertex, using the default shader.
+		[[nodiscard]]
+		static GpuGraphicsPipeline createGraphicsPipeline(SDL_GPUDevice* gpuDevice, const Shader& shader, SDL_GPUTextureFormat colorFormat);
+
+		/// @brief Same pipeline as createGraphicsPipeline, shared through the cache.
+		[[nodiscard]]
+		static SDL_GPUGraphicsPipeline* getGraphicsPipeline(PipelineCache& pipelineCache, const Shader& shader, SDL_GPUTextureFormat colorFormat);
+
+		/// @brief Sets the pipeline, texture and sampler used by sprites added from now on.
+		void setDrawState(const DrawState& state) {
+			batch_.setDrawState(state);
+		}
+
+		void add(const Sprite& sprite);
+
+		void add(std::span<const Sprite> sprites);
+
+		void reserve(size_t spriteCount);
+
+		/// @brief Removes all sprites, call once per frame before adding sprites.
+		void clear();
+
+		/// @brief Pushes the sprites to the streaming buffer, must be called between its beginFrame() and endFrame().
+		void upload(StreamingBuffer& streamingBuffer);
+
+		/// @brief Draws the sprites uploaded by the last call to upload().
+		void draw(SDL_GPURenderPass* renderPass, const StreamingBuffer& streamingBuffer,
+			const std::optional<SDL_Rect>& renderArea = std::nullopt) const;
+
+		const SpriteBatch& getBatch() const noexcept {
+			return batch_;
+		}
+
+	private:
+		SpriteBatch batch_;
+		StreamingBuffer::BatchAllocation allocation_;
+	};
+
+}
+
+#endif
@@ -0,0 +1,77 @@
+#include "staticmesh.h"
+
+#include <cstring>
+
+namespace sdl {
+
+	StaticMesh::StaticMesh(SDL_GPUDevice* gpuDevice, SDL_GPUCommandBuffer* commandBuffer,
+		std::span<const std::byte> vertices, std::span<const std::byte> indices,
+		SDL_GPUIndexElementSize indexElementSize, std::span<const DrawCommand> commands)
+		: commands_(commands.begin(), commands.end())
+		, indexElementSize_{indexElementSize} {
+
+		if (vertices.empty() || indices.empty()) {
+			commands_.clear();
+			return;
+		}
+		const auto vertexBytes = static_cast<Uint32>(vertices.size());
+		const auto indexBytes = static_cast<Uint32>(indices.size());
+
+		vertexBuffer_ = createGpuBuffer(gpuDevice, SDL_GPUBufferCreateInfo{
+			.usage = SDL_GPU_BUFFERUSAGE_VERTEX,
+			.size = vertexBytes
+		});
+		indexBuffer_ = createGpuBuffer(gpuDevice, SDL_GPUBufferCreateInfo{
+			.usage = SDL_GPU_BUFFERUSAGE_INDEX,
+			.size = indexBytes
+		});
+
+		// One transfer buffer for both, released as soon as the upload is recorded.
+		// SDL keeps it alive until the command buffer has finished.
+		auto transferBuffer = createGpuTransferBuffer(gpuDevice, SDL_GPUTransferBufferCreateInfo{
+			.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+			.size = vertexBytes + indexBytes
+		});
+		auto data = static_cast<std::byte*>(SDL_MapGPUTransferBuffer(gpuDevice, transferBuffer.get(), false));
+		if (!data) {
+			throw sdl::SdlException{"[StaticMesh] Failed to map transfer buffer"};
+		}
+		std::memcpy(data, vertices.data(), vertexBytes);
+		std::memcpy(data + vertexBytes, indices.data(), indexBytes);
+		SDL_UnmapGPUTransferBuffer(gpuDevice, transferBuffer.get());
+
+		gpuCopyPass(commandBuffer, [&](SDL_GPUCopyPass* copyPass) {
+			SDL_GPUTransferBufferLocation vertexLocation{
+				.transfer_buffer = transferBuffer.get(),
+				.offset = 0
+			};
+			SDL_GPUBufferRegion vertexRegion{
+				.buffer = vertexBuffer_.get(),
+				.size = vertexBytes
+			};
+			SDL_UploadToGPUBuffer(copyPass, &vertexLocation, &vertexRegion, false);
+
+			SDL_GPUTransferBufferLocation indexLocation{
+				.transfer_buffer = transferBuffer.get(),
+				.offset = vertexBytes
+			};
+			SDL_GPUBufferRegion indexRegion{
+				.buffer = indexBuffer_.get(),
+				.size = indexBytes
+			};
+			SDL_UploadToGPUBuffer(copyPass, &indexLocation, &indexRegion, false);
+		});
+	}
+
+	void StaticMesh::draw(SDL_GPURenderPass* renderPass, const std::optional<SDL_Rect>& renderArea) const {
+		if (isEmpty()) {
+			return;
+		}
+		SDL_GPUBufferBinding vertexBinding{.buffer = vertexBuffer_.get(), .offset = 0};
+		SDL_GPUBufferBinding indexBinding{.buffer = indexBuffer_.get(), .offset = 0};
+		SDL_BindGPUVertexBuffers(renderPass, 0, &vertexBinding, 1);
+		SDL_BindGPUIndexBuffer(renderPass, &indexBinding, indexElementSize_);
+		drawCommands(renderPass, commands_, renderArea);
+	}
+
+}
@@ -0,0 +1,58 @@
+#ifndef CPPSDL3_SDL_STATICMESH_H
+#define CPPSDL3_SDL_STATICMESH_H
+
+#include "gpu.h"
+#include "drawcommand.h"
+
+#include <SDL3/SDL_gpu.h>
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace sdl {
+
+	/// @brief Immutable vertex and index buffer on the GPU together with the draw commands using them.
+	/// Is usually created by Batch::bake().
+	class StaticMesh {
+	public:
+		StaticMesh() = default;
+
+		/// @brief Creates the buffers and records the upload as a copy pass in the command buffer.
+		/// The command buffer must be submitted before the mesh is drawn.
+		StaticMesh(SDL_GPUDevice* gpuDevice, SDL_GPUCommandBuffer* commandBuffer,
+			std::span<const std::byte> vertices, std::span<const std::byte> indices,
+			SDL_GPUIndexElementSize indexElementSize, std::span<const DrawCommand> commands);
+
+		/// @brief Binds the buffers and draws all commands. Does nothing for an empty mesh.
+		/// The render area is required if any command has a scissor, see drawCommands().
+		void draw(SDL_GPURenderPass* renderPass, const std::optional<SDL_Rect>& renderArea = std::nullopt) const;
+
+		[[nodiscard]]
+		bool isEmpty() const noexcept {
+			return !vertexBuffer_;
+		}
+
+		SDL_GPUBuffer* getVertexBuffer() const noexcept {
+			return vertexBuffer_.get();
+		}
+
+		SDL_GPUBuffer* getIndexBuffer() const noexcept {
+			return indexBuffer_.get();
+		}
+
+		std::span<const DrawCommand> commands() const noexcept {
+			return commands_;
+		}
+
+	private:
+		GpuBuffer vertexBuffer_;
+		GpuBuffer indexBuffer_;
+		std::vector<DrawCommand> commands_;
+		SDL_GPUIndexElementSize indexElementSize_ = SDL_GPU_INDEXELEMENTSIZE_32BIT;
+	};
+
+}
+
+#endif
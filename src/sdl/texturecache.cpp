@@ -0,0 +1,300 @@
+#include "texturecache.h"
+#include "mipmap.h"
+#include "sdlexception.h"
+#include "util.h"
+
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3_image/SDL_image.h>
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <memory>
+#include <stdexcept>
+
+namespace sdl {
+
+	namespace {
+
+		constexpr std::array<char, 4> Magic{'C', 'T', 'E', 'X'};
+		constexpr Uint32 Version = 2;
+
+		struct FileHeader {
+			std::array<char, 4> magic = Magic;
+			Uint32 version = Version;
+			Uint64 sourceHash = 0;
+			Uint64 sourceSize = 0;
+			Sint64 sourceModifyTime = 0;
+			Uint32 format = 0;
+			Uint32 width = 0;
+			Uint32 height = 0;
+			Uint32 levelCount = 0;
+			Uint32 rectCount = 0;
+			Uint32 reserved = 0;
+		};
+		static_assert(sizeof(FileHeader) == 56);
+
+		struct IoStreamCloser {
+			void operator()(SDL_IOStream* io) const {
+				SDL_CloseIO(io);
+			}
+		};
+
+		using IoStream = std::unique_ptr<SDL_IOStream, IoStreamCloser>;
+
+		struct SdlFree {
+			void operator()(void* data) const {
+				SDL_free(data);
+			}
+		};
+
+		Uint32 bytesPerPixel(CookedFormat format) {
+			return format == CookedFormat::R8 ? 1 : 4;
+		}
+
+		size_t levelBytes(const CookedTextureInfo& info, Uint32 level) {
+			return static_cast<size_t>(mipLevelSize(info.width, level)) * mipLevelSize(info.height, level) * bytesPerPixel(info.format);
+		}
+
+		bool readExact(SDL_IOStream* io, void* data, size_t size) {
+			return SDL_ReadIO(io, data, size) == size;
+		}
+
+		bool writeExact(SDL_IOStream* io, const void* data, size_t size) {
+			return SDL_WriteIO(io, data, size) == size;
+		}
+
+		FileHeader toFileHeader(const CookedTextureInfo& info) {
+			return FileHeader{
+				.sourceHash = info.sourceHash,
+				.sourceSize = info.sourceSize,
+				.sourceModifyTime = info.sourceModifyTime,
+				.format = static_cast<Uint32>(info.format),
+				.width = info.width,
+				.height = info.height,
+				.levelCount = info.levelCount,
+				.rectCount = static_cast<Uint32>(info.rects.size())
+			};
+		}
+
+		// Overwrites the header of an existing cooked file, e.g. with a new source modification time.
+		void rewriteHeader(const std::string& filename, const CookedTextureInfo& info) {
+			IoStream io{SDL_IOFromFile(filename.c_str(), "r+b")};
+			const FileHeader header = toFileHeader(info);
+			if (!io || !writeExact(io.get(), &header, sizeof(header))) {
+				spdlog::warn("[TextureCache] Failed to update the header of '{}': {}", filename, SDL_GetError());
+			}
+		}
+
+		std::optional<CookedTextureInfo> readInfo(SDL_IOStream* io) {
+			FileHeader header;
+			if (!readExact(io, &header, sizeof(header)) || header.magic != Magic || header.version != Version
+				|| header.format > static_cast<Uint32>(CookedFormat::R8)) {
+				return std::nullopt;
+			}
+			// Bounds the loops over the levels and keeps zero sized textures from reaching the GPU.
+			if (header.width == 0 || header.height == 0 || header.levelCount == 0
+				|| header.levelCount > mipLevelCount(header.width, header.height)) {
+				return std::nullopt;
+			}
+
+			// The rect count is checked against the file before allocating, a corrupt count is not a valid file.
+			const Sint64 size = SDL_GetIOSize(io);
+			const Sint64 position = SDL_TellIO(io);
+			if (size < 0 || position < 0 || static_cast<Uint64>(header.rectCount) * sizeof(SDL_Rect) > static_cast<Uint64>(size - position)) {
+				return std::nullopt;
+			}
+
+			CookedTextureInfo info{
+				.sourceHash = header.sourceHash,
+				.sourceSize = header.sourceSize,
+				.sourceModifyTime = header.sourceModifyTime,
+				.format = static_cast<CookedFormat>(header.format),
+				.width = header.width,
+				.height = header.height,
+				.levelCount = header.levelCount,
+				.rects = std::vector<SDL_Rect>(header.rectCount)
+			};
+			if (!readExact(io, info.rects.data(), info.rects.size() * sizeof(SDL_Rect))) {
+				return std::nullopt;
+			}
+			return info;
+		}
+
+	}
+
+	void writeCookedTexture(const std::string& filename, const CookedTextureInfo& info, std::span<SDL_Surface* const> levels) {
+		if (levels.size() != info.levelCount) {
+			throw std::invalid_argument{fmt::format("Expected {} levels, got {}", info.levelCount, levels.size())};
+		}
+		for (Uint32 level = 0; level < info.levelCount; ++level) {
+			if (static_cast<Uint32>(levels[level]->w) != mipLevelSize(info.width, level)
+				|| static_cast<Uint32>(levels[level]->h) != mipLevelSize(info.height, level)) {
+				throw std::invalid_argument{fmt::format("Level {} has the wrong size", level)};
+			}
+		}
+
+		const std::string temporaryFilename = filename + ".tmp";
+		{
+			IoStream io{SDL_IOFromFile(temporaryFilename.c_str(), "wb")};
+			if (!io) {
+				throw sdl::SdlException{"Failed to open '{}' for writing", temporaryFilename};
+			}
+
+			const FileHeader header = toFileHeader(info);
+			bool written = writeExact(io.get(), &header, sizeof(header))
+				&& writeExact(io.get(), info.rects.data(), info.rects.size() * sizeof(SDL_Rect));
+
+			for (auto surface : levels) {
+				const size_t rowBytes = static_cast<size_t>(surface->w) * bytesPerPixel(info.format);
+				for (int row = 0; written && row < surface->h; ++row) {
+					written = writeExact(io.get(), static_cast<const std::byte*>(surface->pixels) + row * surface->pitch, rowBytes);
+				}
+			}
+			if (!written) {
+				throw sdl::SdlException{"Failed to write '{}'", temporaryFilename};
+			}
+		}
+		if (!SDL_RenamePath(temporaryFilename.c_str(), filename.c_str())) {
+			throw sdl::SdlException{"Failed to rename '{}' to '{}'", temporaryFilename, filename};
+		}
+	}
+
+	std::optional<CookedTextureInfo> readCookedTextureInfo(const std::string& filename) {
+		IoStream io{SDL_IOFromFile(filename.c_str(), "rb")};
+		if (!io) {
+			return std::nullopt;
+		}
+		return readInfo(io.get());
+	}
+
+	CookedTexture loadCookedTexture(UploadQueue& uploadQueue, const std::string& filename) {
+		IoStream io{SDL_IOFromFile(filename.c_str(), "rb")};
+		if (!io) {
+			throw sdl::SdlException{"Failed to open cooked texture '{}'", filename};
+		}
+		auto info = readInfo(io.get());
+		if (!info) {
+			throw std::runtime_error{fmt::format("'{}' is not a cooked texture of version {}", filename, Version)};
+		}
+
+		// Validated before anything is queued, a failed read would otherwise leave a queued upload behind.
+		size_t size = sizeof(FileHeader) + info->rects.size() * sizeof(SDL_Rect);
+		for (Uint32 level = 0; level < info->levelCount; ++level) {
+			size += levelBytes(*info, level);
+		}
+		if (SDL_GetIOSize(io.get()) != static_cast<Sint64>(size)) {
+			throw std::runtime_error{fmt::format("Cooked texture '{}' is truncated", filename)};
+		}
+
+		CookedTexture cooked{
+			.texture = createGpuTexture(uploadQueue.getGpuDevice(), SDL_GPUTextureCreateInfo{
+				.type = SDL_GPU_TEXTURETYPE_2D,
+				.format = info->format == CookedFormat::R8 ? SDL_GPU_TEXTUREFORMAT_R8_UNORM : SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
+				.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER,
+				.width = info->width,
+				.height = info->height,
+				.layer_count_or_depth = 1,
+				.num_levels = info->levelCount,
+			}),
+			.info = std::move(*info)
+		};
+		for (Uint32 level = 0; level < cooked.info.levelCount; ++level) {
+			SDL_Rect rect{
+				0, 0,
+				static_cast<int>(mipLevelSize(cooked.info.width, level)),
+				static_cast<int>(mipLevelSize(cooked.info.height, level))
+			};
+			auto pixels = uploadQueue.mapPixels(cooked.texture.get(), rect, level, bytesPerPixel(cooked.info.format));
+			if (!readExact(io.get(), pixels.data(), pixels.size())) {
+				throw sdl::SdlException{"Failed to read level {} of '{}'", level, filename};
+			}
+		}
+		return cooked;
+	}
+
+	TextureCache::TextureCache(std::string directory)
+		: directory_{std::move(directory)} {
+
+		if (!SDL_CreateDirectory(directory_.c_str())) {
+			spdlog::warn("[TextureCache] Failed to create directory '{}': {}", directory_, SDL_GetError());
+		}
+	}
+
+	GpuTexture TextureCache::load(UploadQueue& uploadQueue, const std::string& filename, bool mipmaps) {
+		SDL_PathInfo pathInfo;
+		if (!SDL_GetPathInfo(filename.c_str(), &pathInfo)) {
+			throw sdl::SdlException{"Failed to get path info of '{}'", filename};
+		}
+
+		const auto path = cookedPath(filename);
+		auto info = readCookedTextureInfo(path);
+		if (info) {
+			const Uint32 levelCount = mipmaps ? mipLevelCount(info->width, info->height) : 1;
+			if (info->format != CookedFormat::Rgba32 || info->levelCount != levelCount) {
+				info.reset();
+			}
+		}
+		// An unchanged size and modification time skips reading the source file.
+		if (info && info->sourceSize == pathInfo.size && info->sourceModifyTime == pathInfo.modify_time) {
+			return loadCookedTexture(uploadQueue, path).texture;
+		}
+
+		size_t size = 0;
+		std::unique_ptr<void, SdlFree> data{SDL_LoadFile(filename.c_str(), &size)};
+		if (!data) {
+			throw sdl::SdlException{"Failed to load file '{}'", filename};
+		}
+		const auto sourceHash = fnv1a(std::span{static_cast<const std::byte*>(data.get()), size});
+
+		if (info && info->sourceHash == sourceHash) {
+			// Touched but not changed, stamp the cooked file so the next load skips the source again.
+			info->sourceSize = size;
+			info->sourceModifyTime = pathInfo.modify_time;
+			rewriteHeader(path, *info);
+			return loadCookedTexture(uploadQueue, path).texture;
+		}
+
+		auto decoded = IMG_Load_IO(SDL_IOFromConstMem(data.get(), size), true);
+		if (!decoded) {
+			throw sdl::SdlException{"Failed to load surface from file '{}'", filename};
+		}
+		auto surface = createSdlSurface(decoded);
+		if (surface->format != SDL_PIXELFORMAT_RGBA32) {
+			surface.reset(SDL_ConvertSurface(surface.get(), SDL_PIXELFORMAT_RGBA32));
+			if (!surface) {
+				throw sdl::SdlException{"Failed to convert '{}' to RGBA32", filename};
+			}
+		}
+
+		std::vector<SdlSurface> mipChain;
+		if (mipmaps) {
+			mipChain = generateMipChain(surface.get());
+		}
+
+		std::vector<SDL_Surface*> levels{surface.get()};
+		for (const auto& level : mipChain) {
+			levels.push_back(level.get());
+		}
+		try {
+			writeCookedTexture(path, CookedTextureInfo{
+				.sourceHash = sourceHash,
+				.sourceSize = size,
+				.sourceModifyTime = pathInfo.modify_time,
+				.width = static_cast<Uint32>(surface->w),
+				.height = static_cast<Uint32>(surface->h),
+				.levelCount = static_cast<Uint32>(levels.size())
+			}, levels);
+		} catch (const std::exception& e) {
+			// The texture is still usable, it is decoded again next time.
+			spdlog::warn("[TextureCache] Failed to cook '{}': {}", filename, e.what());
+		}
+
+		return uploadQueue.uploadSurface(surface.get(), mipChain);
+	}
+
+	std::string TextureCache::cookedPath(const std::string& filename) const {
+		return fmt::format("{}/{:016x}.ctex", directory_, fnv1a(std::as_bytes(std::span{filename})));
+	}
+
+}
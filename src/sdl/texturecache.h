@@ -0,0 +1,98 @@
+#ifndef CPPSDL3_SDL_TEXTURECACHE_H
+#define CPPSDL3_SDL_TEXTURECACHE_H
+
+#include "gpu.h"
+#include "gpuutil.h"
+
+#include <SDL3/SDL_gpu.h>
+#include <SDL3/SDL_rect.h>
+#include <SDL3/SDL_surface.h>
+#include <SDL3/SDL_time.h>
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace sdl {
+
+	constexpr Uint64 Fnv1aOffsetBasis = 14695981039346656037ull;
+
+	/// @brief 64-bit FNV-1a hash, pass the previous result as hash to continue a hash.
+	[[nodiscard]]
+	constexpr Uint64 fnv1a(std::span<const std::byte> data, Uint64 hash = Fnv1aOffsetBasis) noexcept {
+		for (auto byte : data) {
+			hash = (hash ^ static_cast<Uint64>(byte)) * 1099511628211ull;
+		}
+		return hash;
+	}
+
+	enum class CookedFormat : Uint32 {
+		Rgba32 = 0,	///< SDL_PIXELFORMAT_RGBA32 rows, uploaded as R8G8B8A8_UNORM
+		R8 = 1		///< One byte per pixel, e.g. SDL_PIXELFORMAT_INDEX8 rows, uploaded as R8_UNORM
+	};
+
+	/// @brief Header content of a cooked texture file.
+	/// The file is a header, the rects and then each mip level, largest first, as tightly packed rows.
+	struct CookedTextureInfo {
+		Uint64 sourceHash = 0;
+		Uint64 sourceSize = 0;			///< Size of the source file when cooked, checked before the hash
+		SDL_Time sourceModifyTime = 0;	///< Modification time of the source file when cooked, checked before the hash
+		CookedFormat format = CookedFormat::Rgba32;
+		Uint32 width = 0;
+		Uint32 height = 0;
+		Uint32 levelCount = 1;
+		std::vector<SDL_Rect> rects;	///< E.g. the image rects of an atlas
+	};
+
+	struct CookedTexture {
+		GpuTexture texture;
+		CookedTextureInfo info;
+	};
+
+	/// @brief Writes the levels, base level first, as a cooked texture file. The file is written under a
+	/// temporary name and renamed, so a reader never sees a partly written file.
+	void writeCookedTexture(const std::string& filename, const CookedTextureInfo& info, std::span<SDL_Surface* const> levels);
+
+	/// @brief Reads the header of a cooked texture file, or std::nullopt if it does not exist or is not
+	/// a cooked texture of the current version.
+	[[nodiscard]]
+	std::optional<CookedTextureInfo> readCookedTextureInfo(const std::string& filename);
+
+	/// @brief Creates the texture and reads all levels of the cooked texture file straight into the
+	/// mapped transfer buffer of the upload queue, without any intermediate copy or decode.
+	[[nodiscard]]
+	CookedTexture loadCookedTexture(UploadQueue& uploadQueue, const std::string& filename);
+
+	/// @brief Cache of decoded images as cooked texture files, keyed by the file path. A cooked file is used
+	/// directly if the size and modification time of the source file are unchanged. Otherwise the source is
+	/// read and hashed, and only a changed content is decoded and cooked again.
+	class TextureCache {
+	public:
+		/// @param directory Directory of the cooked files, created if missing
+		explicit TextureCache(std::string directory);
+
+		/// @brief Loads the image file through the cache and queues the upload.
+		/// @param uploadQueue Queue the texture levels are uploaded with
+		/// @param filename Source image, any format IMG_Load supports
+		/// @param mipmaps Cooks and uploads a full mip chain, generated with generateMipChain
+		[[nodiscard]]
+		GpuTexture load(UploadQueue& uploadQueue, const std::string& filename, bool mipmaps = false);
+
+		/// @brief Path of the cooked file of the source file.
+		[[nodiscard]]
+		std::string cookedPath(const std::string& filename) const;
+
+		[[nodiscard]]
+		const std::string& getDirectory() const noexcept {
+			return directory_;
+		}
+
+	private:
+		std::string directory_;
+	};
+
+}
+
+#endif
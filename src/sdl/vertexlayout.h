@@ -0,0 +1,122 @@
+#ifndef CPPSDL3_SDL_VERTEXLAYOUT_H
+#define CPPSDL3_SDL_VERTEXLAYOUT_H
+
+#include "color.h"
+#include "gpu.h"
+
+#include <SDL3/SDL_gpu.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace sdl {
+
+	/// @brief Two 16-bit floats, maps to SDL_GPU_VERTEXELEMENTFORMAT_HALF2 and is read as float2 by the shader.
+	struct Half2 {
+		Half2() = default;
+
+		explicit Half2(const glm::vec2& vec)
+			: value{glm::packHalf2x16(vec)} {
+		}
+
+		glm::vec2 toVec2() const {
+			return glm::unpackHalf2x16(value);
+		}
+
+		uint32_t value = 0;
+	};
+
+	/// @brief Maps a vertex member type to its SDL_gpu vertex element format. Specialize to support more types.
+	template <typename T>
+	struct VertexElement;
+
+	template <>
+	struct VertexElement<float> {
+		static constexpr auto Format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT;
+	};
+
+	template <>
+	struct VertexElement<glm::vec2> {
+		static constexpr auto Format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2;
+	};
+
+	template <>
+	struct VertexElement<glm::vec3> {
+		static constexpr auto Format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3;
+	};
+
+	template <>
+	struct VertexElement<glm::vec4> {
+		static constexpr auto Format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4;
+	};
+
+	template <>
+	struct VertexElement<Half2> {
+		static constexpr auto Format = SDL_GPU_VERTEXELEMENTFORMAT_HALF2;
+	};
+
+	// The ImU32 stores red in the lowest byte, i.e. RGBA in memory, and is read as a normalized float4.
+	template <>
+	struct VertexElement<Color> {
+		static constexpr auto Format = SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM;
+	};
+
+	namespace vertex_layout {
+
+		constexpr Uint32 alignUp(Uint32 value, size_t alignment) noexcept {
+			return static_cast<Uint32>((value + alignment - 1) / alignment * alignment);
+		}
+
+	}
+
+	/// @brief Describes a vertex struct by its member types, in declaration order. Offsets and stride are
+	/// derived at compile time using the standard layout rules, and the members map to shader locations 0, 1, ...
+	template <typename... Elements>
+	class VertexLayout {
+	public:
+		static constexpr size_t Size = sizeof...(Elements);
+
+		static constexpr std::array<Uint32, Size> Offsets = [] {
+			std::array<Uint32, Size> offsets{};
+			Uint32 offset = 0;
+			size_t index = 0;
+			((offset = vertex_layout::alignUp(offset, alignof(Elements)), offsets[index++] = offset, offset += sizeof(Elements)), ...);
+			return offsets;
+		}();
+
+		static constexpr Uint32 Stride = [] {
+			Uint32 offset = 0;
+			((offset = vertex_layout::alignUp(offset, alignof(Elements)) + sizeof(Elements)), ...);
+			return vertex_layout::alignUp(offset, std::max({alignof(Elements)...}));
+		}();
+
+		static constexpr std::array<SDL_GPUVertexAttribute, Size> attributes(Uint32 bufferSlot = 0) {
+			std::array<SDL_GPUVertexAttribute, Size> attributes{};
+			Uint32 index = 0;
+			((attributes[index] = SDL_GPUVertexAttribute{
+				.location = index,
+				.buffer_slot = bufferSlot,
+				.format = VertexElement<Elements>::Format,
+				.offset = Offsets[index]
+			}, ++index), ...);
+			return attributes;
+		}
+	};
+
+	/// @brief Vertex buffer description for a vertex type with a nested Layout.
+	template <VertexType Vertex>
+	constexpr SDL_GPUVertexBufferDescription vertexBufferDescription(Uint32 slot = 0) {
+		static_assert(sizeof(Vertex) == Vertex::Layout::Stride, "Vertex::Layout does not match the vertex struct");
+		return SDL_GPUVertexBufferDescription{
+			.slot = slot,
+			.pitch = sizeof(Vertex),
+			.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX
+		};
+	}
+
+}
+
+#endif
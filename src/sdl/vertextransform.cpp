@@ -0,0 +1,87 @@
+#include "vertextransform.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CPPSDL3_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace sdl {
+
+	namespace {
+
+		template <typename T>
+		T& at(T* first, size_t stride, size_t index) noexcept {
+			return *reinterpret_cast<T*>(reinterpret_cast<std::byte*>(first) + stride * index);
+		}
+
+	}
+
+	void transformPositions(const glm::mat4& matrix, glm::vec3* positions, size_t stride, size_t count) noexcept {
+#ifdef CPPSDL3_SSE2
+		const __m128 column0 = _mm_loadu_ps(&matrix[0][0]);
+		const __m128 column1 = _mm_loadu_ps(&matrix[1][0]);
+		const __m128 column2 = _mm_loadu_ps(&matrix[2][0]);
+		const __m128 column3 = _mm_loadu_ps(&matrix[3][0]);
+
+		for (size_t i = 0; i < count; ++i) {
+			auto& position = at(positions, stride, i);
+			__m128 result = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(column0, _mm_set1_ps(position.x)), _mm_mul_ps(column1, _mm_set1_ps(position.y))),
+				_mm_add_ps(_mm_mul_ps(column2, _mm_set1_ps(position.z)), column3));
+
+			// Store only x, y and z, the next member follows directly after the position.
+			_mm_storel_pi(reinterpret_cast<__m64*>(&position.x), result);
+			_mm_store_ss(&position.z, _mm_movehl_ps(result, result));
+		}
+#else
+		for (size_t i = 0; i < count; ++i) {
+			auto& position = at(positions, stride, i);
+			position = glm::vec3{matrix * glm::vec4{position, 1.f}};
+		}
+#endif
+	}
+
+	void transformPositions(const glm::mat4& matrix, glm::vec2* positions, size_t stride, size_t count) noexcept {
+		const glm::mat3x2 matrix2D{
+			glm::vec2{matrix[0]},
+			glm::vec2{matrix[1]},
+			glm::vec2{matrix[3]}
+		};
+		transformPositions(matrix2D, positions, stride, count);
+	}
+
+	void transformPositions(const glm::mat3x2& matrix, glm::vec3* positions, size_t stride, size_t count) noexcept {
+		for (size_t i = 0; i < count; ++i) {
+			auto& position = at(positions, stride, i);
+			const glm::vec2 xy = matrix * glm::vec3{position.x, position.y, 1.f};
+			position.x = xy.x;
+			position.y = xy.y;
+		}
+	}
+
+	void transformPositions(const glm::mat3x2& matrix, glm::vec2* positions, size_t stride, size_t count) noexcept {
+		size_t i = 0;
+#ifdef CPPSDL3_SSE2
+		// Two positions per iteration, (x0, y0, x1, y1).
+		const __m128 column0 = _mm_setr_ps(matrix[0].x, matrix[0].y, matrix[0].x, matrix[0].y);
+		const __m128 column1 = _mm_setr_ps(matrix[1].x, matrix[1].y, matrix[1].x, matrix[1].y);
+		const __m128 column2 = _mm_setr_ps(matrix[2].x, matrix[2].y, matrix[2].x, matrix[2].y);
+
+		for (; i + 1 < count; i += 2) {
+			auto& first = at(positions, stride, i);
+			auto& second = at(positions, stride, i + 1);
+			const __m128 x = _mm_setr_ps(first.x, first.x, second.x, second.x);
+			const __m128 y = _mm_setr_ps(first.y, first.y, second.y, second.y);
+			__m128 result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(column0, x), _mm_mul_ps(column1, y)), column2);
+
+			_mm_storel_pi(reinterpret_cast<__m64*>(&first.x), result);
+			_mm_storeh_pi(reinterpret_cast<__m64*>(&second.x), result);
+		}
+#endif
+		for (; i < count; ++i) {
+			auto& position = at(positions, stride, i);
+			position = matrix * glm::vec3{position, 1.f};
+		}
+	}
+
+}
@@ -0,0 +1,56 @@
+#ifndef CPPSDL3_SDL_VERTEXTRANSFORM_H
+#define CPPSDL3_SDL_VERTEXTRANSFORM_H
+
+#include "color.h"
+
+#include <glm/glm.hpp>
+#include <glm/mat3x2.hpp>
+
+#include <algorithm>
+#include <cstddef>
+
+namespace sdl {
+
+	/// @brief Transforms positions in place, as points (w = 1). Uses SSE2 when available.
+	/// @param matrix Affine transform, the resulting w is ignored
+	/// @param positions Points to the first position
+	/// @param stride Bytes between two positions, i.e. the vertex size
+	/// @param count Number of positions
+	void transformPositions(const glm::mat4& matrix, glm::vec3* positions, size_t stride, size_t count) noexcept;
+
+	/// @brief Transforms 2D positions in place, z = 0 before the transform.
+	void transformPositions(const glm::mat4& matrix, glm::vec2* positions, size_t stride, size_t count) noexcept;
+
+	/// @brief Transforms the x and y of the positions in place, z is left unchanged.
+	void transformPositions(const glm::mat3x2& matrix, glm::vec3* positions, size_t stride, size_t count) noexcept;
+
+	void transformPositions(const glm::mat3x2& matrix, glm::vec2* positions, size_t stride, size_t count) noexcept;
+
+	inline void multiplyColor(glm::vec4& color, const glm::vec4& multiplier) noexcept {
+		color *= multiplier;
+	}
+
+	inline void multiplyColor(Color& color, const glm::vec4& multiplier) noexcept {
+		color = Color{
+			std::clamp(color.red() * multiplier.x, 0.f, 1.f),
+			std::clamp(color.green() * multiplier.y, 0.f, 1.f),
+			std::clamp(color.blue() * multiplier.z, 0.f, 1.f),
+			std::clamp(color.alpha() * multiplier.w, 0.f, 1.f)
+		};
+	}
+
+	/// @brief Vertex with a 2D or 3D position member, which insertTransformed() can transform.
+	template <typename Vertex>
+	concept TransformableVertex = requires(Vertex vertex, const glm::mat4& matrix) {
+		transformPositions(matrix, &vertex.position, sizeof(Vertex), size_t{1});
+	};
+
+	/// @brief Vertex with a color member, which insertTransformed() can multiply.
+	template <typename Vertex>
+	concept ColorVertex = requires(Vertex vertex, const glm::vec4& multiplier) {
+		multiplyColor(vertex.color, multiplier);
+	};
+
+}
+
+#endif
@@ -60,6 +60,41 @@ namespace sdl {
 			});
 		}
 
+		void showGpuMemoryWindow(bool& open) {
+			ImGui::SetNextWindowSize({360.f, 320.f}, ImGuiCond_FirstUseEver);
+			ImGui::Window("GPU Memory", &open, []() {
+				constexpr float MiB = 1024.f * 1024.f;
+				const auto stats = getGpuMemoryStats();
+				ImGui::Text("Live: %.2f MiB", stats.getLiveBytes() / MiB);
+
+				if (ImGui::BeginTable("Resources", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+					ImGui::TableSetupColumn("Type");
+					ImGui::TableSetupColumn("Live");
+					ImGui::TableSetupColumn("MiB");
+					ImGui::TableSetupColumn("Peak MiB");
+					ImGui::TableHeadersRow();
+					for (size_t i = 0; i < stats.resources.size(); ++i) {
+						const auto& resource = stats.resources[i];
+						ImGui::TableNextRow();
+						ImGui::TableNextColumn();
+						ImGui::TextUnformatted(gpuResourceTypeName(static_cast<GpuResourceType>(i)));
+						ImGui::TableNextColumn();
+						ImGui::Text("%zu", resource.liveCount);
+						ImGui::TableNextColumn();
+						ImGui::Text("%.2f", resource.liveBytes / MiB);
+						ImGui::TableNextColumn();
+						ImGui::Text("%.2f", resource.peakBytes / MiB);
+					}
+					ImGui::EndTable();
+				}
+
+				ImGui::SeparatorText("Textures by format");
+				for (const auto& format : stats.textureFormats) {
+					ImGui::Text("Format %d: %zu textures, %.2f MiB", static_cast<int>(format.format), format.liveCount, format.liveBytes / MiB);
+				}
+			});
+		}
+
 		[[nodiscard]] SDL_GPUDevice* initialize(SDL_Window* window) {
 			int driversNbr = SDL_GetNumGPUDrivers();
 			const char* preferredDriver = nullptr;
@@ -117,6 +152,10 @@ namespace sdl {
 
 		if (gpuDevice_) {
 			SDL_WaitForGPUIdle(gpuDevice_);
+			pipelineCache_.reset();
+			samplerCache_.reset();
+			atlasStaging_.reset();
+			releaseQueue_.reset();
 
 			if (window_) {
 				SDL_ReleaseWindowFromGPUDevice(gpuDevice_, window_);
@@ -157,6 +196,10 @@ namespace sdl {
 			);
 		}
 		gpuDevice_ = initialize(window_);
+		releaseQueue_ = std::make_unique<GpuReleaseQueue>(gpuDevice_);
+		pipelineCache_ = std::make_unique<PipelineCache>(gpuDevice_);
+		samplerCache_ = std::make_unique<SamplerCache>(gpuDevice_);
+		atlasStaging_ = std::make_unique<AtlasStaging>(gpuDevice_);
 
 		if (!SDL_SetGPUSwapchainParameters(gpuDevice_, window_, SDL_GPU_SWAPCHAINCOMPOSITION_SDR, SDL_GPU_PRESENTMODE_VSYNC)) {
 			spdlog::warn("[sdl::Window] SDL_SetGPUSwapchainParameters failed: {}", SDL_GetError());
@@ -182,36 +225,40 @@ namespace sdl {
 	void Window::runLoop() {
 		auto time = Clock::now();
 		while (!quit_) {
-			SDL_Event eventSDL;
-			while (SDL_PollEvent(&eventSDL)) {
-				ImGui_ImplSDL3_ProcessEvent(&eventSDL);
-
-				auto& io = ImGui::GetIO();
-				bool ioWantCapture = false;
-				switch (eventSDL.type) {
-					case SDL_EVENT_MOUSE_BUTTON_UP:
-						[[fallthrough]];
-					case SDL_EVENT_MOUSE_BUTTON_DOWN:
-						[[fallthrough]];
-					case SDL_EVENT_MOUSE_MOTION:
-						[[fallthrough]];
-					case SDL_EVENT_MOUSE_WHEEL:
-						ioWantCapture = io.WantCaptureMouse;
-						break;
-					case SDL_EVENT_KEY_UP:
-						[[fallthrough]];
-					case SDL_EVENT_KEY_DOWN:
-						ioWantCapture = io.WantCaptureKeyboard;
-						break;
-					case SDL_EVENT_TEXT_EDITING:
-						[[fallthrough]];
-					case SDL_EVENT_TEXT_INPUT:
-						ioWantCapture = io.WantTextInput;
-						break;
-				}
+			profiler_.beginFrame();
+			{
+				auto scope = profiler_.scope("Events");
+				SDL_Event eventSDL;
+				while (SDL_PollEvent(&eventSDL)) {
+					ImGui_ImplSDL3_ProcessEvent(&eventSDL);
+
+					auto& io = ImGui::GetIO();
+					bool ioWantCapture = false;
+					switch (eventSDL.type) {
+						case SDL_EVENT_MOUSE_BUTTON_UP:
+							[[fallthrough]];
+						case SDL_EVENT_MOUSE_BUTTON_DOWN:
+							[[fallthrough]];
+						case SDL_EVENT_MOUSE_MOTION:
+							[[fallthrough]];
+						case SDL_EVENT_MOUSE_WHEEL:
+							ioWantCapture = io.WantCaptureMouse;
+							break;
+						case SDL_EVENT_KEY_UP:
+							[[fallthrough]];
+						case SDL_EVENT_KEY_DOWN:
+							ioWantCapture = io.WantCaptureKeyboard;
+							break;
+						case SDL_EVENT_TEXT_EDITING:
+							[[fallthrough]];
+						case SDL_EVENT_TEXT_INPUT:
+							ioWantCapture = io.WantTextInput;
+							break;
+					}
 
-				if (!ioWantCapture) {
-					processEvent(eventSDL);
+					if (!ioWantCapture) {
+						processEvent(eventSDL);
+					}
 				}
 			}
 
@@ -219,6 +266,7 @@ namespace sdl {
 			auto delta = currentTime - time;
 			time = currentTime;
 			renderFrame(delta);
+			profiler_.endFrame();
 
 			if (sleepingTime_ > std::chrono::nanoseconds{0}) {
 				std::this_thread::sleep_for(sleepingTime_);
@@ -227,11 +275,17 @@ namespace sdl {
 	}
 
 	void Window::renderFrame(const DeltaTime& deltaTime) {
+		frameArena_.reset();
+		profiler_.gpuFinished(releaseQueue_->collect());
+
 		ImGui_ImplSDLGPU3_NewFrame();
 		ImGui_ImplSDL3_NewFrame();
 		ImGui::NewFrame();
 
-		renderImGui(deltaTime);
+		{
+			auto scope = profiler_.scope("ImGui");
+			renderImGui(deltaTime);
+		}
 
 		if (showDemoWindow_) {
 			ImGui::ShowDemoWindow(&showDemoWindow_);
@@ -239,6 +293,12 @@ namespace sdl {
 		if (showColorWindow_) {
 			showColorWindow(showColorWindow_);
 		}
+		if (showGpuMemoryWindow_) {
+			showGpuMemoryWindow(showGpuMemoryWindow_);
+		}
+		if (showProfilerWindow_) {
+			profiler_.showWindow(showProfilerWindow_);
+		}
 
 		ImGui::Render();
 
@@ -246,15 +306,25 @@ namespace sdl {
 		const bool isMinimized = (drawData->DisplaySize.x <= 0.0f || drawData->DisplaySize.y <= 0.0f);
 
 		SDL_GPUCommandBuffer* commandBuffer = SDL_AcquireGPUCommandBuffer(gpuDevice_);
+		atlasStaging_->flush(commandBuffer);
 
 		SDL_GPUTexture* swapchainTexture;
-		SDL_WaitAndAcquireGPUSwapchainTexture(commandBuffer, window_, &swapchainTexture, nullptr, nullptr);
+		{
+			// Includes waiting for vsync.
+			auto scope = profiler_.scope("Swapchain");
+			SDL_WaitAndAcquireGPUSwapchainTexture(commandBuffer, window_, &swapchainTexture, nullptr, nullptr);
+		}
 		
 		if (swapchainTexture != nullptr && !isMinimized) {
-			// Derived class can override this method to draw additional content.
-			renderFrame(deltaTime, swapchainTexture, commandBuffer);
-
-			ImGui_ImplSDLGPU3_PrepareDrawData(drawData, commandBuffer);
+			{
+				// Derived class can override this method to draw additional content.
+				auto scope = profiler_.scope("Render");
+				renderFrame(deltaTime, swapchainTexture, commandBuffer);
+			}
+			{
+				auto scope = profiler_.scope("ImGui draw");
+				ImGui_ImplSDLGPU3_PrepareDrawData(drawData, commandBuffer);
+			}
 
 			SDL_GPUColorTargetInfo targetInfo{
 				.texture = swapchainTexture,
@@ -271,7 +341,13 @@ namespace sdl {
 			ImGui::RenderPlatformWindowsDefault();
 		}
 
-		SDL_SubmitGPUCommandBuffer(commandBuffer);
+		auto scope = profiler_.scope("Submit");
+		// Resources dropped during the frame are released when the GPU has finished it.
+		SDL_GPUFence* fence = SDL_SubmitGPUCommandBufferAndAcquireFence(commandBuffer);
+		if (fence) {
+			profiler_.gpuSubmitted();
+		}
+		releaseQueue_->endFrame(fence);
 	}
 
 	void Window::renderFrame([[maybe_unused]] const DeltaTime& deltaTime, SDL_GPUTexture* swapchainTexture, SDL_GPUCommandBuffer* commandBuffer) {
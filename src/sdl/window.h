@@ -1,7 +1,13 @@
 #ifndef CPPSDL3_SDL_WINDOW_H
 #define CPPSDL3_SDL_WINDOW_H
 
+#include "atlasstaging.h"
 #include "color.h"
+#include "framearena.h"
+#include "frameprofiler.h"
+#include "gpureleasequeue.h"
+#include "pipelinecache.h"
+#include "samplercache.h"
 #include "util.h"
 
 #include <SDL3/SDL.h>
@@ -49,6 +55,34 @@ namespace sdl {
 			return gpuDevice_;
 		}
 
+		// Memory resource for per-frame allocations, e.g. a Batch filled in renderFrame.
+		// Is reset at the start of each frame, so nothing allocated from it may outlive the frame.
+		FrameArena& getFrameArena() noexcept {
+			return frameArena_;
+		}
+
+		// Times the frames, the GPU work and the CPU sections of the loop. Add own sections with
+		// getFrameProfiler().scope("Name"), e.g. in renderFrame or renderImGui.
+		FrameProfiler& getFrameProfiler() noexcept {
+			return profiler_;
+		}
+
+		// Graphics pipelines shared by everything rendering with the device. Is available from preLoop().
+		PipelineCache& getPipelineCache() noexcept {
+			return *pipelineCache_;
+		}
+
+		// Atlas blits staged during the frame, uploaded in one copy pass at the start of the frame command
+		// buffer, before renderFrame. Is available from preLoop().
+		AtlasStaging& getAtlasStaging() noexcept {
+			return *atlasStaging_;
+		}
+
+		// Samplers shared by everything rendering with the device. Is available from preLoop().
+		SamplerCache& getSamplerCache() noexcept {
+			return *samplerCache_;
+		}
+
 		void setPosition(int x, int y);
 
 		void setSize(int width, int height);
@@ -78,6 +112,14 @@ namespace sdl {
 		bool isShowColorWindow() const;
 		void setShowColorWindow(bool show);
 
+		// Shows the live GPU resources and their estimated memory, see getGpuMemoryStats().
+		bool isShowGpuMemoryWindow() const;
+		void setShowGpuMemoryWindow(bool show);
+
+		// Shows the frame, CPU and GPU times with percentiles, see getFrameProfiler().
+		bool isShowProfilerWindow() const;
+		void setShowProfilerWindow(bool show);
+
 	protected:
 		virtual void preLoop() {}
 		virtual void postLoop() {}
@@ -109,6 +151,12 @@ namespace sdl {
 
 		HitTestCallback onHitTest_;
 		SDL_Surface* icon_ = nullptr;
+		FrameArena frameArena_;
+		FrameProfiler profiler_;
+		std::unique_ptr<GpuReleaseQueue> releaseQueue_;
+		std::unique_ptr<PipelineCache> pipelineCache_;
+		std::unique_ptr<SamplerCache> samplerCache_;
+		std::unique_ptr<AtlasStaging> atlasStaging_;
 		
 		std::string title_;
 		int width_ = DefaultWidth;
@@ -118,6 +166,8 @@ namespace sdl {
 		
 		bool showDemoWindow_ = false;
 		bool showColorWindow_ = false;
+		bool showGpuMemoryWindow_ = false;
+		bool showProfilerWindow_ = false;
 		SDL_WindowFlags flags_ = SDL_WINDOW_RESIZABLE;
 	};
 
@@ -161,6 +211,22 @@ namespace sdl {
 		showColorWindow_ = show;
 	}
 
+	inline bool Window::isShowGpuMemoryWindow() const {
+		return showGpuMemoryWindow_;
+	}
+
+	inline void Window::setShowGpuMemoryWindow(bool show) {
+		showGpuMemoryWindow_ = show;
+	}
+
+	inline bool Window::isShowProfilerWindow() const {
+		return showProfilerWindow_;
+	}
+
+	inline void Window::setShowProfilerWindow(bool show) {
+		showProfilerWindow_ = show;
+	}
+
 }
 
 #endif